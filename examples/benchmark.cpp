@@ -5,6 +5,7 @@
 
 #include "chebyshev.h"
 #include <cmath>
+#include <future>
 using namespace ch;
 
 
@@ -61,6 +62,23 @@ int main(int argc, char const *argv[]) {
 		// You may need to specify the input type
 		// of your function if it isn't deduced.
 
+		// Benchmark an asynchronous operation returning a future,
+		// with at most 4 operations in flight, measuring submission
+		// cost, completion latency and throughput
+		benchmark::benchmark_future("async g(x)", [](double x) {
+			return std::async(std::launch::async, g, x);
+		}, benchmark::async_options<double>(100, 4));
+
+		// Measure the first calls of g(x) in 10 fresh processes,
+		// comparing them to the steady-state runtime
+		benchmark::cold_start("g(x)", g, benchmark::cold_options<double>(10, 16));
+
+		// Measure the slowdown of f(x) under the built-in
+		// interference profiles (memory bandwidth hog, cache
+		// thrasher, busy SMT sibling and system calls)
+		benchmark::benchmark_interference("f(x)", f,
+			benchmark::interference_options<double>(5, 1E+05));
+
 	// Stop benchmarking and exit
 	benchmark::terminate();
 }
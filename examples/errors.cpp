@@ -33,6 +33,11 @@ int main(int argc, char const *argv[]) {
 		// Make an assert
 		err::assert("std::sqrt", std::sqrt(4) == 2, "sqrt(4) is 2");
 
+		// Make many cheap checks, whose description
+		// is only formatted if they fail
+		for (int i = 0; i < 100; ++i)
+			err::check("std::sqrt", std::sqrt(i * i) == i, err::describe("sqrt(", i * i, ") is not ", i));
+
 		// Check errno value after function call
 		err::check_errno("f(x)", f, -1, EDOM);
 
@@ -0,0 +1,98 @@
+///
+/// @file metrics_viewer.cpp Viewer of the live metrics of a test program.
+///
+/// Usage: ./metrics_viewer NAME [INTERVAL_MS]
+///
+/// Reads the live metrics published by a test program run with
+/// "--metrics=NAME" (or CHEBYSHEV_METRICS=NAME), printing them every
+/// INTERVAL_MS milliseconds (500 by default) while they change. The
+/// viewer waits for the segment to be created, exits when the test
+/// program exits and then removes the segment.
+///
+
+#include "core/metrics.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <csignal>
+#include <cerrno>
+using namespace chebyshev;
+
+
+// Whether the process which writes the metrics is still running
+bool alive(uint32_t pid) {
+	return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+
+// Print the metrics on a single line
+void print(const metrics::metrics_data& data) {
+
+	std::cout << "[" << data.module << "] "
+		<< (data.running ? "running" : "idle")
+		<< " | prec " << data.totalTests << " (" << data.failedTests << " failed)"
+		<< " | benchmark " << data.totalBenchmarks << " (" << data.failedBenchmarks << " failed)"
+		<< " | err " << data.totalChecks << " (" << data.failedChecks << " failed)";
+
+	if(data.current[0]) {
+
+		std::cout << " | current: " << data.current;
+
+		if(data.progressTotal)
+			std::cout << " [" << data.progressDone << "/" << data.progressTotal << "]";
+	}
+
+	if(data.benchmark[0])
+		std::cout << " | latest benchmark: " << data.benchmark << " ("
+			<< std::setprecision(4) << data.averageRuntime << " ms)";
+
+	std::cout << std::endl;
+}
+
+
+int main(int argc, const char** argv) {
+
+	if(argc < 2) {
+		std::cout << "Usage: " << argv[0] << " NAME [INTERVAL_MS]" << std::endl;
+		return 1;
+	}
+
+	const std::string name = argv[1];
+	const unsigned int interval = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+
+	// Wait for the test program to create the segment
+	const metrics::metrics_segment* segment = nullptr;
+
+	while(!(segment = metrics::attach(name)))
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+
+	metrics::metrics_data data {};
+	uint64_t updates = 0;
+	bool first = true;
+
+	while(true) {
+
+		if(metrics::read(segment, data) && (first || data.updates != updates)) {
+			print(data);
+			updates = data.updates;
+			first = false;
+		}
+
+		if(!alive(data.pid))
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+	}
+
+	// Print the final state of the metrics
+	if(metrics::read(segment, data) && data.updates != updates)
+		print(data);
+
+	metrics::detach(segment);
+	metrics::remove(name);
+
+	return 0;
+}
@@ -0,0 +1,211 @@
+///
+/// @file overhead.cpp Benchmark of the overhead of the framework.
+///
+/// Each path of the framework is timed against an equivalent
+/// hand-written loop, and the program fails if the overhead
+/// per call exceeds the limits below, which are about 1.5 times
+/// the measured overhead, so that regressions are caught
+/// (the program is run in CI by "make overhead").
+///
+
+#include "chebyshev.h"
+#include <cmath>
+using namespace ch;
+
+
+// Maximum ratio between the runtime of benchmark::runtime
+// and of a hand-written loop over the same function
+const long double RUNTIME_RATIO_LIMIT = 2.0;
+
+// Maximum ratio between calls through std::function
+// and direct calls of the same function
+const long double FUNCTION_RATIO_LIMIT = 2.0;
+
+// Maximum ratio between estimator::quadrature1D
+// and a hand-written Simpson's quadrature
+const long double ESTIMATOR_RATIO_LIMIT = 5.5;
+
+// Maximum cost of registering an equation result (ms per call)
+const long double REGISTRATION_LIMIT = 1E-03;
+
+// Maximum cost of resolving a field of a result (ms per call)
+const long double RESOLVE_LIMIT = 1E-03;
+
+
+// Number of timed repetitions, of which the fastest is used
+const unsigned int RUNS = 10;
+
+// Number of calls per repetition
+const unsigned int CALLS = 100000;
+
+
+// Sink for the results of hand-written loops
+volatile double sink = 0;
+
+
+double f(double x) {
+	return x * std::sqrt(x);
+}
+
+
+/// Time the fastest of many runs of a function, in ms per call.
+template<typename Function>
+long double fastest(Function run) {
+
+	long double best = std::numeric_limits<long double>::infinity();
+
+	for (unsigned int i = 0; i < RUNS; ++i) {
+
+		benchmark::timer t;
+		run();
+		best = std::min(best, t());
+	}
+
+	return best / CALLS;
+}
+
+
+/// Register the overhead of a path of the framework as a benchmark
+/// result and check it against its limit, either on the ratio
+/// with the baseline or on the absolute overhead per call.
+void compare(
+	const std::string& name, long double framework,
+	long double baseline, long double limit, bool ratio) {
+
+	benchmark::benchmark_result res {};
+	res.name = name;
+	res.runs = RUNS;
+	res.iterations = CALLS;
+	res.averageRuntime = framework;
+	res.totalRuntime = framework * CALLS;
+	res.runsPerSecond = 1000.0 / framework;
+	res.additionalFields["baseline"] = baseline;
+	res.additionalFields["overhead"] = framework - baseline;
+	res.additionalFields["limit"] = limit;
+	res.failed = false;
+
+	benchmark::results.totalBenchmarks++;
+	benchmark::results.benchmarkResults[name].push_back(res);
+
+	const long double measured = ratio ? (framework / baseline) : (framework - baseline);
+
+	err::check(name, measured <= limit,
+		err::describe(ratio ? "ratio " : "overhead ", measured, " exceeds ", limit));
+}
+
+
+int main(int argc, char const *argv[]) {
+
+	benchmark::setup("overhead", argc, argv);
+	err::setup("overhead", argc, argv);
+
+		benchmark::settings.benchmarkColumns = {
+			"name", "averageRuntime", "baseline", "overhead", "limit"
+		};
+
+		output::settings.fieldNames["overhead"] = "Overhead (ms)";
+		output::settings.fieldNames["limit"] = "Limit";
+
+		std::vector<double> input (CALLS);
+		for (unsigned int i = 0; i < CALLS; ++i)
+			input[i] = random::uniform(0, 1000);
+
+
+		// Volatile sink and indexing in benchmark::runtime
+		const long double runtimeBaseline = fastest([&]() {
+			double c = 0;
+			for (unsigned int i = 0; i < CALLS; ++i)
+				c += f(input[i]);
+			sink = c;
+		});
+
+		const long double runtimeFramework = fastest([&]() {
+			benchmark::runtime(f, input);
+		});
+
+		compare("benchmark::runtime", runtimeFramework,
+			runtimeBaseline, RUNTIME_RATIO_LIMIT, true);
+
+
+		// Type-erased calls through std::function,
+		// as used by the estimators
+		EndoFunction<double> erased = f;
+
+		const long double functionFramework = fastest([&]() {
+			double c = 0;
+			for (unsigned int i = 0; i < CALLS; ++i)
+				c += erased(input[i]);
+			sink = c;
+		});
+
+		compare("std::function call", functionFramework,
+			runtimeBaseline, FUNCTION_RATIO_LIMIT, true);
+
+
+		// Precision estimation with estimator::quadrature1D,
+		// against Simpson's quadrature on the same nodes
+		// (each node evaluates two functions)
+		auto opt = prec::estimate_options<double, double>(
+			prec::interval(0, 1000), prec::estimator::quadrature1D<double>());
+		opt.iterations = CALLS;
+
+		const long double estimatorBaseline = fastest([&]() {
+
+			const double dx = 1000.0 / CALLS;
+			double sum = 0, sumSqr = 0, max = 0;
+
+			for (unsigned int i = 0; i <= CALLS; ++i) {
+
+				const double x = i * dx;
+				const double diff = std::abs(f(x) - x * std::sqrt(x));
+				const double coeff = (i == 0 || i == CALLS) ? 1 : ((i % 2) ? 4 : 2);
+
+				max = std::max(max, diff);
+				sum += coeff * diff;
+				sumSqr += coeff * diff * diff;
+			}
+
+			sink = sum + sumSqr + max;
+		});
+
+		const long double estimatorFramework = fastest([&]() {
+			opt.estimator(f, [](double x) { return x * std::sqrt(x); }, opt);
+		});
+
+		compare("estimator::quadrature1D", estimatorFramework,
+			estimatorBaseline, ESTIMATOR_RATIO_LIMIT, true);
+
+
+		// Registration of results in the maps of the modules
+		const long double registrationFramework = fastest([&]() {
+
+			for (unsigned int i = 0; i < CALLS; ++i)
+				prec::equals("registration", input[i], input[i], 1E-08, true);
+
+			prec::results = prec::prec_results();
+		});
+
+		compare("prec::equals", registrationFramework,
+			0, REGISTRATION_LIMIT, false);
+
+
+		// Conversion of results to strings for output
+		prec::estimate_result res = opt.estimator(f, f, opt);
+		res.name = "f(x)";
+
+		const long double resolveFramework = fastest([&]() {
+
+			size_t length = 0;
+			for (unsigned int i = 0; i < CALLS; ++i)
+				length += output::resolve_field("maxErr", res).size();
+
+			sink = length;
+		});
+
+		compare("output::resolve_field", resolveFramework,
+			0, RESOLVE_LIMIT, false);
+
+
+	benchmark::terminate(false);
+	err::terminate();
+}
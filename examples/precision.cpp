@@ -27,6 +27,23 @@ double almost_zero(double x) {
 	return 1E-10 * random::uniform(-1, 1);
 }
 
+constexpr double square(double x) {
+	return x * x;
+}
+
+constexpr double square_approx(double x) {
+	return x * x * (1 + 1E-12);
+}
+
+// Precision checks may be evaluated entirely at compile time
+static_assert(prec::static_equals(square(3), 9), "square(3) is 9");
+
+constexpr auto square_estimate = prec::static_estimate<100>(
+	square_approx, square, prec::interval(0, 10), 1E-08
+);
+
+static_assert(!square_estimate.failed, "square_approx(x) is accurate");
+
 
 int main(int argc, char const *argv[]) {
 
@@ -39,12 +56,84 @@ int main(int argc, char const *argv[]) {
 		// Estimate errors on g(x) on [0, 100]
 		prec::estimate("g(x)", g, f, prec::interval(0, 100));
 
+		// Register the result of a compile time estimate
+		prec::estimate("square_approx(x)", square_estimate);
+
 		// Check that two values are equal up to a tolerance
 		prec::equals("f(1) = 1", f(1), 1, 1E-04);
 
 		// Check that two values are equal up to a tolerance
 		prec::equals("g(1) = 1", g(1), 1, 1E-02);
 
+		// Estimate errors on std::sin over float, double and long double
+		// at once, sharing the evaluation of the reference function,
+		// which is evaluated in a type more precise than all of them
+		// (it must be generic and call elementary functions unqualified)
+		prec::estimate_sweep<float, double, long double>(
+			"std::sin(x)",
+			[](auto x) { return std::sin(x); },
+			[](auto x) { using std::sin; return sin(x); },
+			prec::interval(0, 1)
+		);
+
+		// Square roots are correctly rounded, so they must
+		// be within one ULP under every rounding mode
+		prec::sweep_options sweepOpt (prec::interval(1, 100));
+		sweepOpt.roundingModes = prec::sweep::rounding_modes();
+
+		prec::estimate_sweep<float, double>(
+			"std::sqrt(x)",
+			[](auto x) { return std::sqrt(x); },
+			[](long double x) { return std::sqrt(x); },
+			sweepOpt
+		);
+
+		// Prove the error of a Taylor polynomial of the exponential
+		// within tolerance using interval arithmetic, sampling only
+		// the subdomains which cannot be proven (functions must be
+		// generic and call elementary functions unqualified)
+		prec::estimate_bounded(
+			"Taylor exp(x)",
+			[](auto x) { return 1 + x * (1 + x * (0.5 + x * (1.0 / 6 + x / 24))); },
+			[](auto x) { using std::exp; return exp(x); },
+			prec::interval(0, 0.1), 1E-06
+		);
+
+		// Estimate the error of std::exp with respect to a
+		// double-double reference (the reference function must
+		// be generic and call elementary functions unqualified)
+		prec::estimate(
+			"std::exp(x)",
+			[](double x) { return std::exp(x); },
+			prec::reference([](auto x) { return exp(x); }),
+			prec::interval(-1, 1)
+		);
+
+		// Extrapolate the maximum error of a Monte Carlo estimate
+		// from the tail of the 64 largest sampled errors
+		auto mcOpt = prec::estimate_options<double, double>(
+			prec::interval(0, 100),
+			prec::estimator::montecarlo1D<double>()
+		);
+		mcOpt.tail.size = 64;
+		prec::estimate("g(x) (tail)", g, f, mcOpt);
+
+		// Accept a Monte Carlo estimate as soon as the upper
+		// confidence bound of the mean error is within tolerance
+		auto earlyOpt = prec::estimate_options<double, double>(
+			prec::interval(0, 100),
+			prec::estimator::montecarlo1D<double>()
+		);
+		earlyOpt.early.accept = "meanErr";
+		earlyOpt.fail = prec::fail::fail_on_mean_err();
+		prec::estimate("g(x) (early)", g, f, earlyOpt);
+
+		// Test a linear system by its backward error, using a
+		// random well-conditioned matrix and a known solution
+		auto A = prec::residual::well_conditioned(64);
+		auto x = random::array<double>(64, -1, 1);
+		prec::equals_solve("A x = b", A, x, prec::residual::multiply(A, x));
+
 		// Construct options from the test interval and estimator
 		auto opt = prec::estimate_options<double, double>(
 			prec::interval(1.0, 10.0),
@@ -60,6 +149,14 @@ int main(int argc, char const *argv[]) {
 		// Precision test an homogeneous function
 		prec::property::homogeneous("almost_zero(x)", almost_zero, opt);
 
+		// Check multiple properties at once, sharing evaluations
+		prec::property_suite<double> props;
+		props.involution = true;
+		props.decreasing = true;
+		props.inverse = inverse;
+
+		prec::property::suite("inverse(x)", inverse, props, opt);
+
 	// Stop precision testing
 	prec::terminate();
 }
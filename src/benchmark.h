@@ -8,8 +8,13 @@
 
 #include <ctime>
 #include <iostream>
+#include <sstream>
 
 #include "./core/random.h"
+#include "./core/output.h"
+#include "./core/shard.h"
+#include "./core/timing.h"
+#include "./core/cache.h"
 #include "./benchmark/timer.h"
 #include "./benchmark/generator.h"
 #include "./benchmark/benchmark_structures.h"
@@ -61,8 +66,24 @@ namespace chebyshev {
 			std::vector<std::string> benchmarkColumns = {
 				"name", "averageRuntime", "stdevRuntime", "runsPerSecond"
 			};
+
+			/// Default columns to print for cold-start benchmarks.
+			std::vector<std::string> coldStartColumns = {
+				"name", "firstCallP50", "firstCallP90", "firstCallMax",
+				"firstCalls", "steadyRuntime", "coldRatio"
+			};
+
+			/// Default columns to print for benchmarks under interference.
+			std::vector<std::string> interferenceColumns = {
+				"name", "averageRuntime", "stdevRuntime", "slowdown"
+			};
 			
-		} settings;
+		};
+
+
+		/// Settings of the benchmark module,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local benchmark_settings settings;
 
 
 		/// @class benchmark_results Results of benchmarks.
@@ -77,7 +98,20 @@ namespace chebyshev {
 			/// Results of the benchmarks.
 			std::map<std::string, std::vector<benchmark_result>> benchmarkResults {};
 
-		} results;
+			/// Results of the cold-start benchmarks, which are
+			/// reported separately from steady-state results.
+			std::map<std::string, std::vector<benchmark_result>> coldStartResults {};
+
+			/// Results of the benchmarks under interference,
+			/// with a result for each interference profile.
+			std::map<std::string, std::vector<benchmark_result>> interferenceResults {};
+
+		};
+
+
+		/// Results of the benchmark module,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local benchmark_results results;
 
 
 		/// Setup the benchmark environment.
@@ -86,15 +120,19 @@ namespace chebyshev {
 		/// @param argc The number of command line arguments
 		/// @param argv A list of C-style strings containing
 		/// the command line arguments.
-		inline void setup(
+		CHEBYSHEV_INLINE void setup(
 			std::string moduleName,
 			int argc = 0,
-			const char** argv = nullptr) {
+			const char** argv = nullptr)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
-			// Initialize list of picked tests
-			if(argc && argv)
-				for (int i = 1; i < argc; ++i)
-					settings.pickedBenchmarks[argv[i]] = true;
+			// Initialize list of picked tests and sharding,
+			// running as a coordinator of worker processes if requested.
+			for (const std::string& name : shard::setup(moduleName, argc, argv))
+				settings.pickedBenchmarks[name] = true;
 
 			std::cout << "Starting benchmarks of the "
 				<< moduleName << " module ..." << std::endl;
@@ -106,16 +144,37 @@ namespace chebyshev {
 			random::setup();
 			output::setup();
 		}
+#endif
 
 
 		/// Terminate the benchmarking environment.
 		/// If benchmarks have been run, their results will be printed.
 		///
 		/// @param exit Whether to exit after terminating the module.
-		inline void terminate(bool exit = true) {
+		CHEBYSHEV_INLINE void terminate(bool exit = true)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			output::settings.quiet = settings.quiet;
 
+			// Worker processes hand their results to the coordinator,
+			// which writes the merged results to the output files.
+			if(shard::is_worker()) {
+
+				shard::write_results(results.benchmarkResults, settings.benchmarkColumns);
+				shard::write_results(results.coldStartResults, settings.coldStartColumns);
+				shard::write_results(results.interferenceResults, settings.interferenceColumns);
+				shard::write_totals(results.totalBenchmarks, results.failedBenchmarks);
+				shard::write_times(timing::take("benchmark"));
+
+				settings.outputToFile = false;
+				settings.outputFiles.clear();
+				settings.benchmarkOutputFiles.clear();
+				output::settings.outputFiles.clear();
+			}
+
 			// Output to file is true but no specific files are specified, add default output file.
 			if(	 settings.outputToFile &&
 				!output::settings.outputFiles.size() &&
@@ -133,20 +192,39 @@ namespace chebyshev {
 
 			output::print_results(results.benchmarkResults, settings.benchmarkColumns, outputFiles);
 
-			std::cout << "Finished benchmarking " << settings.moduleName << '\n';
-			std::cout << results.totalBenchmarks << " total benchmarks, "
+			output::print_results(results.coldStartResults, settings.coldStartColumns, outputFiles);
+			output::print_results(results.interferenceResults, settings.interferenceColumns, outputFiles);
+
+			// Report the slowest benchmarks
+			timing::print_slowest(timing::take("benchmark"));
+
+			// Publish the termination of the module
+			metrics::end();
+
+			// Format the summary locally, as the formatting state
+			// of std::cout is shared by concurrent contexts
+			std::stringstream summary;
+			summary << "Finished benchmarking " << settings.moduleName << '\n';
+			summary << results.totalBenchmarks << " total benchmarks, "
 				<< results.failedBenchmarks << " failed (" << std::setprecision(3) << 
 				(results.failedBenchmarks / (double) results.totalBenchmarks) * 100 << "%)"
 				<< '\n';
+			std::cout << summary.str();
+
+			// Write updated results to the result cache
+			cache::save();
+
+			const unsigned int failedBenchmarks = results.failedBenchmarks;
 
 			// Discard previous results
 			results = benchmark_results();
 
 			if(exit) {
 				output::terminate();
-				std::exit(results.failedBenchmarks);
+				std::exit(failedBenchmarks);
 			}
 		}
+#endif
 
 
 		/// Measure the total runtime of a function over
@@ -170,38 +248,37 @@ namespace chebyshev {
 			timer t = timer();
 
 			for (unsigned int j = 0; j < input.size(); ++j)
-				c += func(input[j]);
+				c = c + func(input[j]);
 
 			return t();
 		}
 
 
-		/// Run a benchmark on a generic function, with the given input vector.
-		/// The result is registered inside results.benchmarkResults.
+		/// Measure the average runtime of a function over the given
+		/// input for multiple runs, without registering the result.
+		/// The benchmark fails if the function throws an exception.
 		///
-		/// @param name The name of the test case
-		/// @param func The function to benchmark
-		/// @param input The vector of input values
+		/// @param func The function to measure the runtime of
+		/// @param input The vector of inputs
 		/// @param runs The number of runs with the same input
-		template<typename InputType = double, typename Function>
-		inline void benchmark(
-			const std::string& name,
+		/// @return The result of the measurement, without a name
+		template<typename InputType, typename Function>
+		inline benchmark_result measure(
 			Function func,
 			const std::vector<InputType>& input,
-			unsigned int runs = settings.defaultRuns,
-			bool quiet = false) {
+			unsigned int runs) {
 
 			// Whether the benchmark failed because of an exception
 			bool failed = false;
 
 			// Running average
-			long double averageRuntime;
+			long double averageRuntime = 0;
 
 			// Running total sum of squares
-			long double sumSquares;
+			long double sumSquares = 0;
 
 			// Total runtime
-			long double totalRuntime;
+			long double totalRuntime = 0;
 
 			try {
 
@@ -231,22 +308,102 @@ namespace chebyshev {
 			}
 
 			benchmark_result res {};
-			res.name = name;
 			res.runs = runs;
 			res.iterations = input.size();
 			res.totalRuntime = totalRuntime;
 			res.averageRuntime = averageRuntime;
 			res.runsPerSecond = 1000.0 / res.averageRuntime;
 			res.failed = failed;
-			res.quiet = quiet;
 
 			if (runs > 1)
 				res.stdevRuntime = std::sqrt(sumSquares / (runs - 1));
 
+			return res;
+		}
+
+
+		/// Returns whether a benchmark should run,
+		/// according to the picked benchmarks and the current shard.
+		///
+		/// @param name The name of the benchmark
+		inline bool should_run(const std::string& name) {
+
+			if(settings.pickedBenchmarks.size())
+				if(settings.pickedBenchmarks.find(name) == settings.pickedBenchmarks.end())
+					return false;
+
+			return shard::selected(name);
+		}
+
+
+		/// Run a benchmark on a generic function, with the given input vector.
+		/// The result is registered inside results.benchmarkResults.
+		///
+		/// @param name The name of the test case
+		/// @param func The function to benchmark
+		/// @param input The vector of input values
+		/// @param runs The number of runs with the same input
+		template<typename InputType = double, typename Function>
+		inline void benchmark(
+			const std::string& name,
+			Function func,
+			const std::vector<InputType>& input,
+			unsigned int runs = settings.defaultRuns,
+			bool quiet = false) {
+
+			// Skip the benchmark if it was not picked
+			// or it belongs to another shard.
+			if(!should_run(name))
+				return;
+
+			// Measure the wall time of the test case
+			const timer watch;
+			metrics::start(name);
+
+			std::string cacheKey;
+
+			if(cache::settings.enabled) {
+
+				cacheKey = cache::key(name,
+					"runs=" + std::to_string(runs) +
+					";iterations=" + std::to_string(input.size()));
+
+				// Reuse the cached result if available
+				benchmark_result res {};
+
+				if(cache::lookup(cacheKey, res)) {
+
+					res.name = name + " [cached]";
+					res.quiet = quiet;
+					res.wallTime = watch.get();
+					res.failed = timing::record("benchmark", name, res.wallTime) || res.failed;
+
+					results.totalBenchmarks++;
+					if(res.failed)
+						results.failedBenchmarks++;
+
+					metrics::benchmark_case(res.name, res.averageRuntime, res.failed);
+
+					results.benchmarkResults[name].push_back(res);
+					return;
+				}
+			}
+
+			benchmark_result res = measure(func, input, runs);
+			res.name = name;
+			res.quiet = quiet;
+
+			cache::store(cacheKey, res);
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("benchmark", name, res.wallTime) || res.failed;
+
 			results.totalBenchmarks++;
-			if(failed)
+			if(res.failed)
 				results.failedBenchmarks++;
 
+			metrics::benchmark_case(res.name, res.averageRuntime, res.failed);
+
 			results.benchmarkResults[name].push_back(res);
 		}
 
@@ -263,6 +420,11 @@ namespace chebyshev {
 			Function func,
 			const benchmark_options<InputType>& opt) {
 
+			// Skip the benchmark before generating its input,
+			// if it was not picked or it belongs to another shard.
+			if(!should_run(name))
+				return;
+
 			// Generate input set
 			std::vector<InputType> input (opt.iterations);
 			for (unsigned int i = 0; i < opt.iterations; ++i)
@@ -298,6 +460,21 @@ namespace chebyshev {
 
 			benchmark(name, func, opt);
 		}
+
+
+#ifdef CHEBYSHEV_COMPILED
+
+		// Instantiations for real functions of real variable,
+		// defined in the compiled library.
+		extern template void benchmark<double, EndoFunction<double>>(
+			const std::string&, EndoFunction<double>,
+			const std::vector<double>&, unsigned int, bool);
+
+		extern template void benchmark<double, EndoFunction<double>>(
+			const std::string&, EndoFunction<double>,
+			const benchmark_options<double>&);
+
+#endif
 	}
 }
 
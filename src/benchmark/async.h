@@ -0,0 +1,454 @@
+///
+/// @file async.h Benchmarks of asynchronous operations.
+///
+
+#ifndef CHEBYSHEV_ASYNC_H
+#define CHEBYSHEV_ASYNC_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+#ifdef __cpp_impl_coroutine
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define CHEBYSHEV_COROUTINES
+#endif
+#endif
+
+#include "../benchmark.h"
+
+
+namespace chebyshev {
+
+	namespace benchmark {
+
+
+		/// @namespace chebyshev::benchmark::async Asynchronous benchmarks
+		///
+		/// Asynchronous operations are submitted with a bounded number
+		/// of operations in flight, measuring the cost of submission,
+		/// the distribution of the completion latency (from submission
+		/// to completion) and the sustained throughput. Operations may
+		/// complete through a std::future, a callback or, since C++20,
+		/// a coroutine awaitable.
+		namespace async {
+
+
+			/// @class tracker
+			/// Submission and completion times of the operations
+			/// of an asynchronous benchmark, which may be completed
+			/// from any thread.
+			struct tracker {
+
+				/// Time of submission of each operation (ms).
+				std::vector<long double> submitted;
+
+				/// Time of completion of each operation (ms).
+				std::vector<long double> completed;
+
+				/// Whether each operation was completed, so that
+				/// operations are only completed once.
+				std::vector<char> done;
+
+				/// Total time spent submitting operations (ms).
+				long double submitCost = 0;
+
+				/// Number of operations in flight.
+				unsigned int inFlight = 0;
+
+				/// Whether any operation failed.
+				bool failed = false;
+
+				/// Timer started at the beginning of the benchmark.
+				timer clock;
+
+				std::mutex mutex;
+				std::condition_variable cv;
+
+
+				/// Construct a tracker for the given number of operations.
+				tracker(unsigned int operations)
+				: submitted(operations), completed(operations), done(operations, 0) {}
+
+
+				/// Mark an operation as submitted, after waiting
+				/// for the number of operations in flight to be
+				/// below the given limit.
+				inline void begin(size_t i, unsigned int maxInFlight) {
+
+					std::unique_lock<std::mutex> lock (mutex);
+					cv.wait(lock, [&]() { return inFlight < maxInFlight; });
+
+					inFlight++;
+					submitted[i] = clock();
+				}
+
+
+				/// Mark an operation as completed, optionally marking
+				/// it as failed. Operations which were already completed
+				/// are only marked as failed, if requested.
+				inline void complete(size_t i, bool hasFailed = false) {
+
+					const long double t = clock();
+
+					{
+						std::lock_guard<std::mutex> lock (mutex);
+						failed = failed || hasFailed;
+
+						if(done[i])
+							return;
+
+						done[i] = 1;
+						completed[i] = t;
+						inFlight--;
+					}
+
+					cv.notify_all();
+				}
+
+
+				/// Wait for all operations in flight to complete.
+				inline void drain() {
+
+					std::unique_lock<std::mutex> lock (mutex);
+					cv.wait(lock, [&]() { return inFlight == 0; });
+				}
+			};
+
+
+			/// Compute the given quantile of a sorted vector.
+			inline long double quantile(const std::vector<long double>& sorted, long double q) {
+
+				if(!sorted.size())
+					return get_nan<long double>();
+
+				const size_t i = std::min<size_t>(q * sorted.size(), sorted.size() - 1);
+				return sorted[i];
+			}
+
+
+			/// Register the result of an asynchronous benchmark.
+			/// The averageRuntime and stdevRuntime fields hold the mean
+			/// and standard deviation of the completion latency, while
+			/// runsPerSecond holds the sustained throughput in operations
+			/// per second. The average submission cost, the quantiles of
+			/// the latency and the maximum number of operations in flight
+			/// are stored as additional fields.
+			inline void register_result(
+				const std::string& name,
+				tracker& tr,
+				long double totalRuntime,
+				unsigned int maxInFlight,
+				long double wallTime,
+				bool quiet) {
+
+				const size_t n = tr.submitted.size();
+				std::vector<long double> latency (n);
+
+				long double mean = 0;
+				long double sumSquares = 0;
+
+				for (size_t i = 0; i < n; ++i) {
+
+					latency[i] = tr.completed[i] - tr.submitted[i];
+
+					const long double tmp = mean;
+					mean = tmp + (latency[i] - tmp) / (i + 1);
+					sumSquares += (latency[i] - tmp) * (latency[i] - mean);
+				}
+
+				std::sort(latency.begin(), latency.end());
+
+				benchmark_result res {};
+				res.name = name;
+				res.runs = 1;
+				res.iterations = n;
+				res.totalRuntime = totalRuntime;
+				res.averageRuntime = mean;
+				res.runsPerSecond = n / totalRuntime * 1000.0;
+				res.failed = tr.failed;
+				res.quiet = quiet;
+
+				if(n > 1)
+					res.stdevRuntime = std::sqrt(sumSquares / (n - 1));
+
+				res.additionalFields["submitCost"] = n ? (tr.submitCost / n) : 0;
+				res.additionalFields["latencyP50"] = quantile(latency, 0.50);
+				res.additionalFields["latencyP90"] = quantile(latency, 0.90);
+				res.additionalFields["latencyP99"] = quantile(latency, 0.99);
+				res.additionalFields["latencyMax"] = n ? latency.back() : 0;
+				res.additionalFields["inFlight"] = maxInFlight;
+
+				res.wallTime = wallTime;
+				res.failed = timing::record("benchmark", name, res.wallTime) || res.failed;
+
+				results.totalBenchmarks++;
+				if(res.failed)
+					results.failedBenchmarks++;
+
+				metrics::benchmark_case(res.name, res.averageRuntime, res.failed);
+
+				results.benchmarkResults[name].push_back(res);
+			}
+
+		}
+
+
+		/// Benchmark an asynchronous operation which signals its
+		/// completion by calling a callback, possibly from another thread.
+		/// The function is called with an input value and a callback
+		/// taking no arguments, which must be called exactly once
+		/// (or never, if the function throws).
+		///
+		/// @param name The name of the test case
+		/// @param func The function starting the operation
+		/// @param opt The options of the asynchronous benchmark
+		template<typename InputType = double, typename Function>
+		inline void benchmark_callback(
+			const std::string& name,
+			Function func,
+			const async_options<InputType>& opt = async_options<InputType>()) {
+
+			if(!should_run(name))
+				return;
+
+			// Measure the wall time of the test case
+			const timer watch;
+			metrics::start(name);
+
+			std::vector<InputType> input (opt.operations);
+			for (unsigned int i = 0; i < opt.operations; ++i)
+				input[i] = opt.inputGenerator(i);
+
+			async::tracker tr (opt.operations);
+			const unsigned int maxInFlight = std::max(opt.maxInFlight, 1u);
+
+			tr.clock.start();
+
+			for (size_t i = 0; i < input.size(); ++i) {
+
+				tr.begin(i, maxInFlight);
+
+				try {
+					func(input[i], std::function<void()>([&tr, i]() { tr.complete(i); }));
+				} catch(...) {
+					tr.complete(i, true);
+				}
+
+				tr.submitCost += tr.clock() - tr.submitted[i];
+			}
+
+			tr.drain();
+
+			async::register_result(name, tr, tr.clock(), maxInFlight, watch.get(), opt.quiet);
+		}
+
+
+		/// Benchmark an asynchronous operation which returns a future
+		/// (or any type with the get() and wait_for() methods of
+		/// std::future, such as std::shared_future). The operation fails
+		/// if get() throws. Completion is observed by the benchmarking
+		/// thread, which polls all the operations in flight without
+		/// blocking after each submission and while the limit is reached,
+		/// so that each operation is completed as soon as it is ready,
+		/// whatever the order of completion.
+		///
+		/// @param name The name of the test case
+		/// @param func The function starting the operation
+		/// @param opt The options of the asynchronous benchmark
+		template<typename InputType = double, typename Function>
+		inline void benchmark_future(
+			const std::string& name,
+			Function func,
+			const async_options<InputType>& opt = async_options<InputType>()) {
+
+			if(!should_run(name))
+				return;
+
+			// Measure the wall time of the test case
+			const timer watch;
+			metrics::start(name);
+
+			std::vector<InputType> input (opt.operations);
+			for (unsigned int i = 0; i < opt.operations; ++i)
+				input[i] = opt.inputGenerator(i);
+
+			using Future = decltype(func(input[0]));
+
+			async::tracker tr (opt.operations);
+			const unsigned int maxInFlight = std::max(opt.maxInFlight, 1u);
+			std::vector<std::pair<size_t, Future>> pending;
+
+			// Complete the operations in flight which are ready
+			// (or deferred), returning whether any was completed
+			auto poll = [&]() {
+
+				bool any = false;
+
+				for (size_t k = 0; k < pending.size();) {
+
+					if(pending[k].second.wait_for(std::chrono::seconds(0))
+						== std::future_status::timeout) {
+						k++;
+						continue;
+					}
+
+					bool hasFailed = false;
+
+					try {
+						pending[k].second.get();
+					} catch(...) {
+						hasFailed = true;
+					}
+
+					tr.complete(pending[k].first, hasFailed);
+					pending[k] = std::move(pending.back());
+					pending.pop_back();
+					any = true;
+				}
+
+				return any;
+			};
+
+			// Wait until fewer than the given number of operations are in flight
+			auto waitBelow = [&](size_t limit) {
+				while(pending.size() >= limit)
+					if(!poll())
+						std::this_thread::yield();
+			};
+
+			tr.clock.start();
+
+			for (size_t i = 0; i < input.size(); ++i) {
+
+				poll();
+				waitBelow(maxInFlight);
+
+				tr.begin(i, maxInFlight);
+
+				try {
+					pending.emplace_back(i, func(input[i]));
+				} catch(...) {
+					tr.complete(i, true);
+				}
+
+				tr.submitCost += tr.clock() - tr.submitted[i];
+			}
+
+			waitBelow(1);
+
+			async::register_result(name, tr, tr.clock(), maxInFlight, watch.get(), opt.quiet);
+		}
+
+
+#ifdef CHEBYSHEV_COROUTINES
+
+		namespace async {
+
+
+			/// @class detached_task
+			/// A coroutine which starts immediately and
+			/// destroys itself when it completes.
+			struct detached_task {
+
+				struct promise_type {
+
+					detached_task get_return_object() noexcept {
+						return {};
+					}
+
+					std::suspend_never initial_suspend() noexcept {
+						return {};
+					}
+
+					std::suspend_never final_suspend() noexcept {
+						return {};
+					}
+
+					void return_void() noexcept {}
+
+					void unhandled_exception() noexcept {}
+				};
+			};
+
+
+			/// Await an awaitable and then signal its completion.
+			template<typename Awaitable>
+			inline detached_task await_operation(Awaitable awaitable, tracker& tr, size_t i) {
+
+				bool hasFailed = false;
+
+				try {
+					co_await std::move(awaitable);
+				} catch(...) {
+					hasFailed = true;
+				}
+
+				tr.complete(i, hasFailed);
+			}
+
+		}
+
+
+		/// Benchmark an asynchronous operation which returns
+		/// a C++20 coroutine awaitable. Each awaitable is awaited
+		/// by a detached coroutine which signals the completion of
+		/// the operation when it is resumed.
+		///
+		/// @param name The name of the test case
+		/// @param func The function returning the awaitable
+		/// @param opt The options of the asynchronous benchmark
+		template<typename InputType = double, typename Function>
+		inline void benchmark_coroutine(
+			const std::string& name,
+			Function func,
+			const async_options<InputType>& opt = async_options<InputType>()) {
+
+			if(!should_run(name))
+				return;
+
+			// Measure the wall time of the test case
+			const timer watch;
+			metrics::start(name);
+
+			std::vector<InputType> input (opt.operations);
+			for (unsigned int i = 0; i < opt.operations; ++i)
+				input[i] = opt.inputGenerator(i);
+
+			async::tracker tr (opt.operations);
+			const unsigned int maxInFlight = std::max(opt.maxInFlight, 1u);
+
+			tr.clock.start();
+
+			for (size_t i = 0; i < input.size(); ++i) {
+
+				tr.begin(i, maxInFlight);
+
+				try {
+					async::await_operation(func(input[i]), tr, i);
+				} catch(...) {
+					tr.complete(i, true);
+				}
+
+				tr.submitCost += tr.clock() - tr.submitted[i];
+			}
+
+			tr.drain();
+
+			async::register_result(name, tr, tr.clock(), maxInFlight, watch.get(), opt.quiet);
+		}
+
+#endif
+
+	}
+}
+
+#endif
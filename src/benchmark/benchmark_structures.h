@@ -8,6 +8,10 @@
 
 #include <functional>
 #include <map>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <limits>
 
 #include "../core/common.h"
 #include "./generator.h"
@@ -50,6 +54,12 @@ namespace chebyshev {
 			/// Whether to print to standard output or not.
 			bool quiet = false;
 
+			/// Whether the result was read from the result cache.
+			bool cached = false;
+
+			/// Wall time spent on the test case, in milliseconds.
+			long double wallTime = 0;
+
 			/// Additional fields in floating point representation.
 			std::map<std::string, long double> additionalFields {};
 
@@ -99,6 +109,193 @@ namespace chebyshev {
 
 		};
 
+
+		/// @class async_options
+		/// A structure holding the options of an asynchronous benchmark.
+		template<typename InputType = double>
+		struct async_options {
+
+			/// Total number of operations to submit.
+			unsigned int operations = CHEBYSHEV_BENCHMARK_ITER;
+
+			/// Maximum number of operations in flight at the same time
+			/// (submission waits for a completion when it is reached).
+			unsigned int maxInFlight = CHEBYSHEV_BENCHMARK_IN_FLIGHT;
+
+			/// The function to use to generate input for the operations.
+			InputGenerator<InputType> inputGenerator = generator::uniform1D(0, 1);
+
+			/// Whether to print to standard output or not.
+			bool quiet = false;
+
+
+			/// Default constructor for asynchronous benchmark options.
+			async_options() {}
+
+			/// Construct asynchronous benchmark options from the number
+			/// of operations, the maximum number of operations in flight
+			/// and whether to print the case to output (defaults to false).
+			async_options(unsigned int operations, unsigned int maxInFlight, bool quiet = false)
+			: operations(operations), maxInFlight(maxInFlight), quiet(quiet) {}
+
+			/// Construct asynchronous benchmark options from the number
+			/// of operations, the maximum number of operations in flight,
+			/// the input generator to use and whether to print the case to output.
+			async_options(
+				unsigned int operations,
+				unsigned int maxInFlight,
+				InputGenerator<InputType> gen,
+				bool quiet = false)
+			: operations(operations), maxInFlight(maxInFlight), inputGenerator(gen), quiet(quiet) {}
+
+		};
+
+
+		/// @class cold_options
+		/// A structure holding the options of a cold-start benchmark.
+		template<typename InputType = double>
+		struct cold_options {
+
+			/// Number of fresh processes to launch, each
+			/// providing a sample of the first-call latency.
+			unsigned int samples = CHEBYSHEV_BENCHMARK_COLD_SAMPLES;
+
+			/// Number of first calls timed in each process.
+			unsigned int calls = 16;
+
+			/// Number of runs of the steady-state benchmark
+			/// over the same inputs, used for comparison.
+			unsigned int runs = CHEBYSHEV_BENCHMARK_RUNS;
+
+			/// The function to use to generate input for the calls.
+			InputGenerator<InputType> inputGenerator = generator::uniform1D(0, 1);
+
+			/// Whether to print to standard output or not.
+			bool quiet = false;
+
+
+			/// Default constructor for cold-start benchmark options.
+			cold_options() {}
+
+			/// Construct cold-start benchmark options from the number
+			/// of processes, the number of first calls timed in each
+			/// process and whether to print the case to output.
+			cold_options(unsigned int samples, unsigned int calls, bool quiet = false)
+			: samples(samples), calls(calls), quiet(quiet) {}
+
+			/// Construct cold-start benchmark options from the number
+			/// of processes, the number of first calls timed in each
+			/// process, the input generator to use and whether
+			/// to print the case to output.
+			cold_options(
+				unsigned int samples,
+				unsigned int calls,
+				InputGenerator<InputType> gen,
+				bool quiet = false)
+			: samples(samples), calls(calls), inputGenerator(gen), quiet(quiet) {}
+
+		};
+
+
+		/// A function which is run by each thread of an
+		/// interference profile, until the stop flag is set.
+		/// The function calls ready() once its setup (such as allocating
+		/// and touching buffers) is done and the load is running.
+		using InterferenceFunction = std::function<
+			void(const std::atomic<bool>& stop, const std::function<void()>& ready)>;
+
+
+		/// @class interference_profile
+		/// A load which runs alongside a benchmark
+		/// on other threads, to simulate noisy neighbors.
+		struct interference_profile {
+
+			/// Identifying name of the profile.
+			std::string name = "unknown";
+
+			/// The function run by each thread of the profile.
+			InterferenceFunction work = [](const std::atomic<bool>&, const std::function<void()>&) {};
+
+			/// Number of threads running the function.
+			unsigned int threads = 1;
+
+			/// Whether the threads should run on the SMT sibling of
+			/// the core of the benchmark, when threads are pinned.
+			bool sibling = false;
+
+
+			/// Default constructor for interference profiles.
+			interference_profile() {}
+
+			/// Construct an interference profile from its name,
+			/// its function and the number of threads. The function must
+			/// call ready() once its setup is done and before loading the
+			/// machine, as the benchmark waits for all threads to be ready
+			/// (for at most one second, after which it proceeds anyway).
+			interference_profile(
+				const std::string& name,
+				InterferenceFunction work,
+				unsigned int threads = 1,
+				bool sibling = false)
+			: name(name), work(work), threads(threads), sibling(sibling) {}
+
+		};
+
+
+		/// @class interference_options
+		/// A structure holding the options of a benchmark
+		/// under interference.
+		template<typename InputType = double>
+		struct interference_options {
+
+			/// Number of runs (run with the same input values).
+			unsigned int runs = CHEBYSHEV_BENCHMARK_RUNS;
+
+			/// Number of iterations.
+			unsigned int iterations = CHEBYSHEV_BENCHMARK_ITER;
+
+			/// The function to use to generate input for the benchmark.
+			InputGenerator<InputType> inputGenerator = generator::uniform1D(0, 1);
+
+			/// The interference profiles to run the benchmark under
+			/// (all built-in profiles are used if empty).
+			std::vector<interference_profile> profiles {};
+
+			/// Whether to pin the benchmark and the interfering threads
+			/// to distinct CPUs (only supported on Linux).
+			bool pin = false;
+
+			/// The CPU to pin the benchmark to, when pinning.
+			unsigned int cpu = 0;
+
+			/// Maximum slowdown with respect to the quiet machine,
+			/// above which the benchmark fails.
+			long double maxSlowdown = std::numeric_limits<long double>::infinity();
+
+			/// Whether to print to standard output or not.
+			bool quiet = false;
+
+
+			/// Default constructor for interference options.
+			interference_options() {}
+
+			/// Construct interference options from the number of runs and
+			/// iterations and whether to print the case to output.
+			interference_options(unsigned int runs, unsigned int iterations, bool quiet = false)
+			: runs(runs), iterations(iterations), quiet(quiet) {}
+
+			/// Construct interference options from the number of runs and
+			/// iterations, the input generator to use and whether to print
+			/// the case to output.
+			interference_options(
+				unsigned int runs,
+				unsigned int iterations,
+				InputGenerator<InputType> gen,
+				bool quiet = false)
+			: runs(runs), iterations(iterations), inputGenerator(gen), quiet(quiet) {}
+
+		};
+
 	}
 }
 
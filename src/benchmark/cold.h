@@ -0,0 +1,264 @@
+///
+/// @file cold.h Cold-start benchmarks.
+///
+
+#ifndef CHEBYSHEV_COLD_H
+#define CHEBYSHEV_COLD_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "../benchmark.h"
+
+
+namespace chebyshev {
+
+	namespace benchmark {
+
+
+		/// @namespace chebyshev::benchmark::cold Cold-start benchmarks
+		///
+		/// The first calls of a function in a process may be much slower
+		/// than the following ones, because of lazy binding of symbols,
+		/// static initialization, page faults and cache misses. Cold-start
+		/// benchmarks measure these calls by launching a fresh process of
+		/// the same program for each sample, with the "--cold-start=NAME"
+		/// option, which skips every test case of the program except for
+		/// the cold-start benchmark with the given name. The
+		/// program must therefore pass the command line arguments to the
+		/// setup function of the module.
+		namespace cold {
+
+
+			/// Prefix of the files used to exchange samples with
+			/// cold-start processes, which contains the identifier
+			/// of the process, as workers and other programs with
+			/// the same module name may run concurrently.
+			inline std::string prefix() {
+				return settings.moduleName + "_cold_" + std::to_string(shard::process_id());
+			}
+
+
+			/// Time the first calls of a function in the current process,
+			/// which was launched by a cold-start benchmark, write the
+			/// runtime of the very first call and of all the first calls
+			/// to the sample file and exit the process.
+			template<typename InputType, typename Function>
+			inline void run_sample(Function func, const std::vector<InputType>& input) {
+
+				long double first = get_nan<long double>();
+				long double total = get_nan<long double>();
+
+				try {
+
+					timer t = timer();
+					__volatile__ auto c = func(input[0]);
+					first = t();
+
+					for (size_t i = 1; i < input.size(); ++i)
+						c = c + func(input[i]);
+
+					total = t();
+
+				} catch(...) {}
+
+				std::ofstream file (shard::settings.coldOutput);
+				file.precision(std::numeric_limits<long double>::max_digits10);
+				file << first << " " << total << "\n";
+				file.close();
+
+				std::exit(0);
+			}
+
+
+			/// Launch a fresh process of the program which times
+			/// the first calls of the given test case, returning
+			/// whether the sample was read successfully.
+			///
+			/// @param name The name of the test case
+			/// @param first The runtime of the first call (ms)
+			/// @param total The total runtime of the first calls (ms)
+			inline bool launch(const std::string& name, long double& first, long double& total) {
+
+				const std::string filename = prefix() + ".sample";
+
+				std::vector<std::string> arguments = shard::settings.arguments;
+				arguments.push_back("--cold-start=" + name);
+				arguments.push_back("--cold-output=" + filename);
+
+				std::remove(filename.c_str());
+				shard::run_process(shard::settings.program, arguments, prefix() + ".log");
+
+				std::ifstream file (filename);
+				const bool success = (file >> first >> total) && (first == first) && (total == total);
+				file.close();
+
+				std::remove(filename.c_str());
+				std::remove((prefix() + ".log").c_str());
+
+				return success;
+			}
+
+		}
+
+
+		/// Benchmark the first calls of a function in fresh processes.
+		/// For each sample, the program is launched again and runs only
+		/// this test case, timing the very first call of the function and
+		/// the first calls over the whole input. The distribution of the
+		/// first-call latency is registered in results.coldStartResults,
+		/// separately from steady-state results, together with the
+		/// steady-state runtime per call over the same inputs in the
+		/// current process. The averageRuntime and stdevRuntime fields
+		/// hold the mean and standard deviation of the first-call latency,
+		/// while the additional fields hold its quantiles ("firstCallP50",
+		/// "firstCallP90", "firstCallMax"), the average runtime per call
+		/// of the first calls ("firstCalls"), the steady-state runtime
+		/// per call ("steadyRuntime") and the ratio between the mean
+		/// first-call latency and the steady-state runtime ("coldRatio").
+		///
+		/// @param name The name of the test case
+		/// @param func The function to benchmark
+		/// @param opt The options of the cold-start benchmark
+		template<typename InputType = double, typename Function>
+		inline void cold_start(
+			const std::string& name,
+			Function func,
+			const cold_options<InputType>& opt = cold_options<InputType>()) {
+
+			const unsigned int calls = std::max(opt.calls, 1u);
+
+			// Time the first calls and exit, in the cold-start
+			// process of this benchmark, skipping the others.
+			if(shard::is_cold_start()) {
+
+				if(shard::settings.coldStart != name)
+					return;
+
+				std::vector<InputType> input (calls);
+				for (unsigned int i = 0; i < calls; ++i)
+					input[i] = opt.inputGenerator(i);
+
+				cold::run_sample(func, input);
+			}
+
+			// Skip the benchmark if any benchmarks have been picked
+			// and this one was not picked.
+			if(settings.pickedBenchmarks.size())
+				if(settings.pickedBenchmarks.find(name) == settings.pickedBenchmarks.end())
+					return;
+
+			// Skip the benchmark if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const timer watch;
+			metrics::start(name);
+
+			std::vector<InputType> input (calls);
+			for (unsigned int i = 0; i < calls; ++i)
+				input[i] = opt.inputGenerator(i);
+
+			if(!shard::settings.program.size())
+				throw std::runtime_error(
+					"Command line arguments are needed to launch processes in benchmark::cold_start");
+
+			std::vector<long double> first;
+			long double firstCalls = 0;
+			bool failed = false;
+
+			for (unsigned int i = 0; i < opt.samples; ++i) {
+
+				long double f, total;
+
+				if(!cold::launch(name, f, total)) {
+					failed = true;
+					continue;
+				}
+
+				first.push_back(f);
+				firstCalls += total / input.size();
+			}
+
+			// Steady-state runtime per call over the same inputs
+			long double steadyRuntime = get_nan<long double>();
+
+			try {
+
+				for (unsigned int i = 0; i < std::max(opt.runs, 1u); ++i) {
+
+					const long double current = runtime(func, input) / input.size();
+
+					if(!(current >= steadyRuntime))
+						steadyRuntime = current;
+				}
+
+			} catch(...) {
+				failed = true;
+			}
+
+			long double mean = 0;
+			long double sumSquares = 0;
+
+			for (size_t i = 0; i < first.size(); ++i) {
+
+				const long double tmp = mean;
+				mean = tmp + (first[i] - tmp) / (i + 1);
+				sumSquares += (first[i] - tmp) * (first[i] - mean);
+			}
+
+			std::sort(first.begin(), first.end());
+
+			// Quantile of the sorted first-call latencies
+			auto quantile = [&](long double q) {
+
+				if(!first.size())
+					return get_nan<long double>();
+
+				return first[std::min<size_t>(q * first.size(), first.size() - 1)];
+			};
+
+			benchmark_result res {};
+			res.name = name;
+			res.runs = first.size();
+			res.iterations = input.size();
+			res.totalRuntime = mean * first.size();
+			res.averageRuntime = first.size() ? mean : get_nan<long double>();
+			res.runsPerSecond = 1000.0 / res.averageRuntime;
+			res.failed = failed || !first.size();
+			res.quiet = opt.quiet;
+
+			if(first.size() > 1)
+				res.stdevRuntime = std::sqrt(sumSquares / (first.size() - 1));
+
+			res.additionalFields["firstCallP50"] = quantile(0.50);
+			res.additionalFields["firstCallP90"] = quantile(0.90);
+			res.additionalFields["firstCallMax"] = first.size() ? first.back() : get_nan<long double>();
+			res.additionalFields["firstCalls"] = first.size() ? (firstCalls / first.size()) : get_nan<long double>();
+			res.additionalFields["steadyRuntime"] = steadyRuntime;
+			res.additionalFields["coldRatio"] = res.averageRuntime / steadyRuntime;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("benchmark", name, res.wallTime) || res.failed;
+
+			results.totalBenchmarks++;
+			if(res.failed)
+				results.failedBenchmarks++;
+
+			metrics::benchmark_case(res.name, res.averageRuntime, res.failed);
+
+			results.coldStartResults[name].push_back(res);
+		}
+
+	}
+}
+
+#endif
@@ -7,6 +7,7 @@
 #define CHEYBYSHEV_GENERATOR_H
 
 #include <functional>
+#include <string>
 #include "../core/common.h"
 #include "../core/random.h"
 
@@ -25,6 +26,26 @@ namespace benchmark {
 			};
 		}
 
+
+		/// Generator of random strings of the given length,
+		/// made of human-readable ASCII characters
+		inline auto string(size_t length) {
+
+			return [=](unsigned int i) {
+				return random::string(length);
+			};
+		}
+
+
+		/// Generator of random strings of the given length,
+		/// made of the elements of the given alphabet
+		inline auto string(size_t length, const std::string& alphabet) {
+
+			return [=](unsigned int i) {
+				return random::string(length, alphabet);
+			};
+		}
+
 	}
 
 }}
@@ -0,0 +1,420 @@
+///
+/// @file interference.h Benchmarks under interference of noisy neighbors.
+///
+
+#ifndef CHEBYSHEV_INTERFERENCE_H
+#define CHEBYSHEV_INTERFERENCE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "../benchmark.h"
+
+
+namespace chebyshev {
+
+	namespace benchmark {
+
+
+		/// @namespace chebyshev::benchmark::interference Interference profiles
+		///
+		/// Benchmarks on a quiet machine are optimistic when the code
+		/// shares cores and caches with other processes in production.
+		/// Interference profiles run a load on other threads while a
+		/// benchmark is measured, such as a memory bandwidth hog, a last
+		/// level cache thrasher, a busy SMT sibling or a thread making
+		/// many system calls, and the slowdown with respect to the quiet
+		/// machine is reported for each profile.
+		namespace interference {
+
+
+			/// A memory bandwidth hog, which repeatedly copies
+			/// a buffer much larger than the caches.
+			///
+			/// @param bytes The size of the buffers to copy
+			/// @param threads The number of threads
+			inline interference_profile bandwidth(
+				size_t bytes = 64 << 20, unsigned int threads = 1) {
+
+				return interference_profile("bandwidth", [=](const std::atomic<bool>& stop, const std::function<void()>& ready) {
+
+					std::vector<char> src (bytes, 1);
+					std::vector<char> dst (bytes, 0);
+					const size_t chunk = 1 << 16;
+
+					ready();
+
+					while(!stop.load(std::memory_order_relaxed))
+						for (size_t i = 0; i + chunk <= bytes; i += chunk)
+							std::memcpy(&dst[i], &src[i], chunk);
+
+				}, threads);
+			}
+
+
+			/// A last level cache thrasher, which writes to the cache lines
+			/// of a buffer larger than the cache in an order which defeats
+			/// hardware prefetching.
+			///
+			/// @param bytes The size of the buffer
+			/// (rounded down to a power of two)
+			/// @param threads The number of threads
+			inline interference_profile cache(
+				size_t bytes = 32 << 20, unsigned int threads = 1) {
+
+				return interference_profile("cache", [=](const std::atomic<bool>& stop, const std::function<void()>& ready) {
+
+					size_t lines = 1;
+					while(lines * 2 * 64 <= bytes)
+						lines *= 2;
+
+					std::vector<uint8_t> buffer (lines * 64);
+					const size_t mask = lines - 1;
+					size_t line = 0;
+
+					ready();
+
+					while(!stop.load(std::memory_order_relaxed)) {
+
+						// Full period linear congruential
+						// walk over the cache lines
+						for (unsigned int i = 0; i < 4096; ++i) {
+							line = (line * 5 + 1) & mask;
+							buffer[line * 64]++;
+						}
+					}
+
+				}, threads);
+			}
+
+
+			/// A busy thread on the SMT sibling of the core running the
+			/// benchmark (when threads are pinned), competing for its
+			/// execution units with integer and floating point arithmetic.
+			///
+			/// @param threads The number of threads
+			inline interference_profile spin(unsigned int threads = 1) {
+
+				return interference_profile("spin", [](const std::atomic<bool>& stop, const std::function<void()>& ready) {
+
+					uint64_t x = 1;
+					double y = 1;
+
+					ready();
+
+					while(!stop.load(std::memory_order_relaxed)) {
+
+						for (unsigned int i = 0; i < 4096; ++i) {
+							x = x * 6364136223846793005ull + 1442695040888963407ull;
+							y = y * 1.0000001 + 1E-09;
+						}
+					}
+
+					volatile uint64_t sink = x + (uint64_t) y;
+					(void) sink;
+
+				}, threads, true);
+			}
+
+
+			/// A thread making many system calls, which causes
+			/// kernel entries, cache and TLB pollution and
+			/// scheduler activity.
+			///
+			/// @param threads The number of threads
+			inline interference_profile syscalls(unsigned int threads = 1) {
+
+				return interference_profile("syscall", [](const std::atomic<bool>& stop, const std::function<void()>& ready) {
+
+					ready();
+
+					while(!stop.load(std::memory_order_relaxed)) {
+#ifdef __linux__
+						::syscall(SYS_getppid);
+#endif
+						std::this_thread::yield();
+					}
+
+				}, threads);
+			}
+
+
+			/// The built-in interference profiles.
+			inline std::vector<interference_profile> profiles() {
+				return { bandwidth(), cache(), spin(), syscalls() };
+			}
+
+
+			/// Returns the SMT sibling of the given CPU, or another CPU
+			/// if it has none (or the topology cannot be read).
+			inline unsigned int sibling(unsigned int cpu) {
+
+				std::ifstream file ("/sys/devices/system/cpu/cpu"
+					+ std::to_string(cpu) + "/topology/thread_siblings_list");
+
+				std::string list;
+				if(file >> list) {
+
+					// The list is either "A,B" or "A-B"
+					for (size_t i = 0; i < list.size(); ++i) {
+
+						if(list[i] != ',' && list[i] != '-')
+							continue;
+
+						const unsigned int a = std::stoul(list.substr(0, i));
+						const unsigned int b = std::stoul(list.substr(i + 1));
+
+						if(a != cpu)
+							return a;
+
+						if(b != cpu)
+							return (list[i] == '-') ? (cpu + 1) : b;
+					}
+				}
+
+				const unsigned int n = std::max(std::thread::hardware_concurrency(), 1u);
+				return (cpu + 1) % n;
+			}
+
+
+			/// Pin a thread to a CPU, returning whether it succeeded.
+			/// Pinning is only supported on Linux.
+			inline bool pin(std::thread::native_handle_type handle, unsigned int cpu) {
+#ifdef __linux__
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				CPU_SET(cpu, &set);
+				return pthread_setaffinity_np(handle, sizeof(set), &set) == 0;
+#else
+				(void) handle;
+				(void) cpu;
+				return false;
+#endif
+			}
+
+
+			/// Choose the CPUs of the threads of an interference profile,
+			/// avoiding the core of the benchmark unless the profile
+			/// runs on its SMT sibling.
+			inline std::vector<unsigned int> cpus(
+				const interference_profile& profile, unsigned int benchmarkCpu) {
+
+				const unsigned int n = std::max(std::thread::hardware_concurrency(), 1u);
+				const unsigned int siblingCpu = sibling(benchmarkCpu);
+				std::vector<unsigned int> res;
+
+				if(profile.sibling) {
+					res.assign(profile.threads, siblingCpu);
+					return res;
+				}
+
+				unsigned int cpu = benchmarkCpu;
+
+				for (unsigned int i = 0; i < profile.threads; ++i) {
+
+					// Skip the core of the benchmark, if possible
+					for (unsigned int k = 0; k < n; ++k) {
+
+						cpu = (cpu + 1) % n;
+
+						if(cpu != benchmarkCpu && cpu != siblingCpu)
+							break;
+					}
+
+					res.push_back(cpu);
+				}
+
+				return res;
+			}
+
+
+			/// @class load
+			/// The threads of an interference profile which are
+			/// running, until the load is stopped or destroyed.
+			class load {
+
+				std::atomic<bool> stop {false};
+				std::atomic<bool> go {false};
+				std::atomic<unsigned int> started {0};
+				std::vector<std::thread> threads;
+
+				public:
+
+				/// Start the threads of an interference profile,
+				/// optionally pinned to the given CPUs, and wait
+				/// for all of them to have finished their setup,
+				/// for at most the given timeout (in seconds), so that
+				/// functions which never call ready() do not hang.
+				/// The threads wait for all of them to be pinned
+				/// before doing any work.
+				load(
+					const interference_profile& profile,
+					const std::vector<unsigned int>& cpus = {},
+					long double timeout = 1.0) {
+
+					for (unsigned int i = 0; i < profile.threads; ++i) {
+
+						InterferenceFunction work = profile.work;
+
+						threads.emplace_back([this, work]() {
+
+							while(!go.load())
+								std::this_thread::yield();
+
+							bool signalled = false;
+							const std::function<void()> ready = [this, &signalled]() {
+								if(!signalled) {
+									signalled = true;
+									started++;
+								}
+							};
+
+							work(stop, ready);
+
+							// Functions which return early
+							// are never waited for
+							ready();
+						});
+
+						if(i < cpus.size())
+							pin(threads.back().native_handle(), cpus[i]);
+					}
+
+					go = true;
+
+					const timer t;
+
+					while(started.load() < threads.size() && t.get() < timeout * 1000)
+						std::this_thread::yield();
+				}
+
+
+				/// Stop and join the threads of the profile.
+				inline void join() {
+
+					stop = true;
+					go = true;
+
+					for (std::thread& t : threads)
+						if(t.joinable())
+							t.join();
+				}
+
+
+				~load() {
+					join();
+				}
+			};
+
+		}
+
+
+		/// Run a benchmark on a generic function under each of the
+		/// given interference profiles, on the same input. A result is
+		/// registered in results.interferenceResults for the quiet machine,
+		/// named "name (quiet)", and for each profile, named after the test
+		/// case and the profile (e.g. "f(x) (bandwidth)"), with the ratio
+		/// between the average runtime under interference and on the quiet
+		/// machine stored in the "slowdown" additional field. The benchmark
+		/// fails if any slowdown exceeds opt.maxSlowdown.
+		///
+		/// @param name The name of the test case
+		/// @param func The function to benchmark
+		/// @param opt The options of the benchmark under interference
+		template<typename InputType = double, typename Function>
+		inline void benchmark_interference(
+			const std::string& name,
+			Function func,
+			const interference_options<InputType>& opt = interference_options<InputType>()) {
+
+			// Skip the benchmark if any benchmarks have been picked
+			// and this one was not picked.
+			if(settings.pickedBenchmarks.size())
+				if(settings.pickedBenchmarks.find(name) == settings.pickedBenchmarks.end())
+					return;
+
+			// Skip the benchmark if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			metrics::start(name);
+
+			std::vector<InputType> input (opt.iterations);
+			for (unsigned int i = 0; i < opt.iterations; ++i)
+				input[i] = opt.inputGenerator(i);
+
+			const std::vector<interference_profile> profiles =
+				opt.profiles.size() ? opt.profiles : interference::profiles();
+
+#ifdef __linux__
+
+			// Pin the benchmark, restoring its affinity at the end
+			cpu_set_t previous;
+			const bool pinned = opt.pin &&
+				!pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) &&
+				interference::pin(pthread_self(), opt.cpu);
+#else
+			const bool pinned = false;
+#endif
+
+			// Register a result, computing its slowdown
+			timer watch;
+			const benchmark_result quiet = measure(func, input, opt.runs);
+
+			auto registerResult = [&](benchmark_result res, const std::string& profileName) {
+
+				res.name = name + " (" + profileName + ")";
+				res.quiet = opt.quiet;
+				res.additionalFields["slowdown"] = res.averageRuntime / quiet.averageRuntime;
+				res.failed = res.failed || quiet.failed ||
+					(res.additionalFields["slowdown"] > opt.maxSlowdown);
+
+				// Each profile is timed separately, including its load
+				res.wallTime = watch.get();
+				res.failed = timing::record("benchmark", res.name, res.wallTime) || res.failed;
+
+				results.totalBenchmarks++;
+				if(res.failed)
+					results.failedBenchmarks++;
+
+				metrics::benchmark_case(res.name, res.averageRuntime, res.failed);
+
+				results.interferenceResults[res.name].push_back(res);
+			};
+
+			registerResult(quiet, "quiet");
+
+			for (const interference_profile& profile : profiles) {
+
+				watch.start();
+				interference::load l (profile,
+					pinned ? interference::cpus(profile, opt.cpu) : std::vector<unsigned int>());
+
+				const benchmark_result res = measure(func, input, opt.runs);
+				l.join();
+
+				registerResult(res, profile.name);
+			}
+
+#ifdef __linux__
+			if(pinned)
+				pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+#endif
+		}
+
+	}
+}
+
+#endif
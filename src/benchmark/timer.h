@@ -37,14 +37,12 @@ namespace chebyshev {
 				/// start of the timer in milliseconds.
 				inline long double get() const {
 
-					auto start = std::chrono::time_point_cast<std::chrono::milliseconds>(s)
-									.time_since_epoch();
+					// Keep the full resolution of the clock
+					// instead of truncating to milliseconds.
+					const std::chrono::duration<long double, std::milli> elapsed =
+						std::chrono::high_resolution_clock::now() - s;
 
-					auto end = std::chrono::time_point_cast<std::chrono::milliseconds>(
-								std::chrono::high_resolution_clock::now())
-									.time_since_epoch();
-
-					return (long double) (end - start).count();
+					return elapsed.count();
 				}
 
 
@@ -0,0 +1,68 @@
+///
+/// @file chebyshev.cpp Translation unit of the compiled library.
+///
+/// When the framework is built as a library (e.g. using "make lib"),
+/// this file defines the global objects, the non-template functions and
+/// the common template instantiations of all modules, which are then only
+/// declared by the headers included with CHEBYSHEV_COMPILED defined.
+///
+
+#ifndef CHEBYSHEV_COMPILED
+#define CHEBYSHEV_COMPILED
+#endif
+
+#define CHEBYSHEV_IMPLEMENTATION
+#include "chebyshev.h"
+
+
+namespace chebyshev {
+
+	namespace output {
+
+		template void print_results(
+			const std::map<std::string, std::vector<prec::estimate_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		template void print_results(
+			const std::map<std::string, std::vector<prec::equation_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		template void print_results(
+			const std::map<std::string, std::vector<benchmark::benchmark_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		template void print_results(
+			const std::map<std::string, std::vector<err::assert_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		template void print_results(
+			const std::map<std::string, std::vector<err::errno_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		template void print_results(
+			const std::map<std::string, std::vector<err::exception_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+	}
+
+	namespace prec {
+
+		template void estimate<double, double>(
+			const std::string&, EndoFunction<double>, EndoFunction<double>,
+			estimate_options<double, double>);
+
+		template void equals<double>(
+			const std::string&, const double&, const double&,
+			equation_options<double>);
+	}
+
+	namespace benchmark {
+
+		template void benchmark<double, EndoFunction<double>>(
+			const std::string&, EndoFunction<double>,
+			const std::vector<double>&, unsigned int, bool);
+
+		template void benchmark<double, EndoFunction<double>>(
+			const std::string&, EndoFunction<double>,
+			const benchmark_options<double>&);
+	}
+}
@@ -4,8 +4,14 @@
 ///
 
 #include "prec.h"
+#include "prec/shadow.h"
 #include "benchmark.h"
+#include "benchmark/async.h"
+#include "benchmark/cold.h"
+#include "benchmark/interference.h"
 #include "err.h"
+#include "err/error_paths.h"
+#include "context.h"
 
 /// @namespace chebyshev General namespace of the framework
 namespace chebyshev {}
@@ -0,0 +1,20 @@
+///
+/// @file chebyshev_fwd.h Header of the compiled library.
+///
+/// Test translation units which link against the compiled library
+/// (built from src/chebyshev.cpp) include this header instead of
+/// chebyshev.h. Global objects and non-template functions are only
+/// declared, and the common template instantiations are not repeated,
+/// so that multiple test translation units may be linked together.
+///
+
+#ifndef CHEBYSHEV_FWD_H
+#define CHEBYSHEV_FWD_H
+
+#ifndef CHEBYSHEV_COMPILED
+#define CHEBYSHEV_COMPILED
+#endif
+
+#include "chebyshev.h"
+
+#endif
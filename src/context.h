@@ -0,0 +1,135 @@
+///
+/// @file context.h Instanced test contexts.
+///
+
+#ifndef CHEBYSHEV_CONTEXT_H
+#define CHEBYSHEV_CONTEXT_H
+
+#include <vector>
+#include <utility>
+
+#include "prec.h"
+#include "benchmark.h"
+#include "err.h"
+
+
+namespace chebyshev {
+
+
+	/// @class context
+	/// A test context, owning the settings, results and output state
+	/// (including the open output files) of all modules.
+	///
+	/// The free functions of the modules and their settings and results
+	/// (e.g. prec::settings and prec::results) operate on the state of the
+	/// calling thread, which acts as its default context. Running a function
+	/// in a context exchanges the state of the calling thread with the state
+	/// of the context for the duration of the call, so that independent test
+	/// suites may run concurrently on different threads of a long-lived
+	/// process, each with its own settings, results and output files, and
+	/// may be resumed later, possibly on another thread.
+	///
+	/// @note A context may only be used by one thread at a time, and the
+	/// modules must be terminated without exiting (e.g. prec::terminate(false))
+	/// inside a context. Sharding, the result cache, live metrics and the
+	/// settings of wall time accounting remain global to the process:
+	/// they are setup once, by the first module to be setup, and the
+	/// result cache and live metrics are locked on access. The random
+	/// generators of the modules draw from the engine of the context.
+	class context {
+		public:
+
+			/// Settings of the precision testing module.
+			prec::prec_settings precSettings {};
+
+			/// Results of the precision testing module.
+			prec::prec_results precResults {};
+
+			/// Settings of the benchmark module.
+			benchmark::benchmark_settings benchmarkSettings {};
+
+			/// Results of the benchmark module.
+			benchmark::benchmark_results benchmarkResults {};
+
+			/// Settings of the error checking module.
+			err::err_settings errSettings {};
+
+			/// Results of the error checking module.
+			err::err_results errResults {};
+
+			/// Settings of the output module, including the open output files.
+			output::output_settings outputSettings {};
+
+			/// Wall times of the test cases which have not been reported yet.
+			std::vector<timing::case_time> timingRecords {};
+
+			/// Settings of the random module.
+			random::random_settings randomSettings {};
+
+			/// Engine of the bulk random generators.
+			random::xoshiro256 randomEngine {};
+
+
+			/// Construct a context with the default settings,
+			/// in which the modules have not been setup yet.
+			context() {}
+
+
+			context(const context&) = delete;
+			context& operator=(const context&) = delete;
+
+
+			/// Run a function in the context, with the state of the
+			/// context as the state of the calling thread, and return
+			/// its result. The state of the thread is restored when the
+			/// function returns or throws.
+			///
+			/// @param f The function to run, taking no arguments
+			template<typename Function>
+			inline auto run(Function f) -> decltype(f()) {
+
+				scope s (*this);
+				return f();
+			}
+
+
+		private:
+
+			/// Exchange the state of the context
+			/// with the state of the calling thread.
+			inline void exchange() {
+
+				std::swap(prec::settings, precSettings);
+				std::swap(prec::results, precResults);
+				std::swap(benchmark::settings, benchmarkSettings);
+				std::swap(benchmark::results, benchmarkResults);
+				std::swap(err::settings, errSettings);
+				std::swap(err::results, errResults);
+				std::swap(output::settings, outputSettings);
+				std::swap(timing::records, timingRecords);
+				std::swap(random::settings, randomSettings);
+				std::swap(random::engine, randomEngine);
+			}
+
+
+			/// Exchanges the state of a context with the state of the
+			/// calling thread on construction and again on destruction.
+			class scope {
+
+				context& c;
+
+				public:
+
+				scope(context& c) : c(c) {
+					c.exchange();
+				}
+
+				~scope() {
+					c.exchange();
+				}
+			};
+	};
+
+}
+
+#endif
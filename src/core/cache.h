@@ -0,0 +1,482 @@
+///
+/// @file cache.h Result cache for incremental re-execution of test cases.
+///
+
+#ifndef CHEBYSHEV_CACHE_H
+#define CHEBYSHEV_CACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <iostream>
+#include <stdexcept>
+
+#include "./common.h"
+#include "./random.h"
+#include "../prec/prec_structures.h"
+#include "../benchmark/benchmark_structures.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CHEBYSHEV_CACHE_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace chebyshev {
+
+	/// @namespace chebyshev::cache Result cache
+	///
+	/// When enabled, the results of precision estimates and benchmarks
+	/// are stored in a cache file, keyed by the name of the test case,
+	/// a user-provided version of the code under test and the options
+	/// of the test case. Test cases with a matching key reuse the cached
+	/// result instead of being executed again, and are marked in the
+	/// output by the " [cached]" suffix of their name.
+	/// Re-execution can be forced by setting cache::settings.force or
+	/// the CHEBYSHEV_CACHE_FORCE environment variable.
+	///
+	/// The key of a precision estimate contains the types of its estimator
+	/// and fail function, but not the parameters they capture (such as the
+	/// number of subdomains of estimator::decomposition), so the version
+	/// must be changed when only these parameters change.
+	namespace cache {
+
+
+		/// A cached result, as a map of field names to values.
+		using record = std::map<std::string, long double>;
+
+
+		/// @class cache_settings
+		/// Global settings of the result cache.
+		struct cache_settings {
+
+			/// Whether to use the result cache (disabled by default).
+			bool enabled = false;
+
+			/// Whether to re-execute all test cases,
+			/// overwriting their cached results.
+			bool force = false;
+
+			/// The file to read and write cached results to.
+			std::string filename = "chebyshev_cache";
+
+			/// Version or hash of the code under test, shared by all
+			/// test cases. Results of a different version are not reused.
+			std::string version = "";
+
+			/// Versions or hashes of specific test cases, by name,
+			/// which are combined with the global version.
+			std::map<std::string, std::string> versions {};
+
+			/// Whether the seed of the random module is part of the key,
+			/// so that results of randomized test cases are reused only
+			/// if the same seed is used (off by default, as the default
+			/// seed depends on time).
+			bool includeSeed = false;
+
+		};
+
+
+		/// Global settings of the result cache.
+		CHEBYSHEV_GLOBAL cache_settings settings;
+
+
+		/// @class cache_state
+		/// The records of the cache, loaded on first use.
+		struct cache_state {
+
+			/// Records read from the cache file, by key.
+			std::map<std::string, record> records {};
+
+			/// Keys of the records which were added or updated
+			/// by the current process.
+			std::map<std::string, bool> updated {};
+
+			/// Whether the cache file was read.
+			bool loaded = false;
+
+			/// Serializes the access of the threads of the process
+			/// to the records, as concurrent contexts share the cache.
+			std::mutex mutex;
+
+		};
+
+
+		/// Global state of the result cache.
+		CHEBYSHEV_GLOBAL cache_state state;
+
+
+		/// Read the records of a cache file into a map.
+		/// Each line contains a key and a list of field and value
+		/// pairs, separated by tabs.
+		CHEBYSHEV_INLINE void read(const std::string& filename, std::map<std::string, record>& records)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			std::ifstream file (filename);
+			std::string line;
+
+			while(std::getline(file, line)) {
+
+				std::stringstream ss (line);
+				std::string key, entry;
+
+				if(!std::getline(ss, key, '\t'))
+					continue;
+
+				record r;
+
+				while(std::getline(ss, entry, '\t')) {
+
+					const size_t pos = entry.find('=');
+
+					if(pos == std::string::npos)
+						continue;
+
+					r[entry.substr(0, pos)] = std::strtold(entry.c_str() + pos + 1, nullptr);
+				}
+
+				records[key] = r;
+			}
+		}
+#endif
+
+
+		/// Load the cache file, if it was not already loaded.
+		CHEBYSHEV_INLINE void load()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			std::lock_guard<std::mutex> lock (state.mutex);
+
+			if(state.loaded)
+				return;
+
+			const char* force = std::getenv("CHEBYSHEV_CACHE_FORCE");
+			if(force && std::string(force) != "0")
+				settings.force = true;
+
+			read(settings.filename, state.records);
+			state.loaded = true;
+		}
+#endif
+
+
+		/// @class file_lock
+		/// An exclusive advisory lock on a file, which is held
+		/// for the lifetime of the object (only on POSIX systems).
+		struct file_lock {
+
+			/// The descriptor of the locked file.
+			int fd = -1;
+
+			/// Lock the file with the given name, creating it if needed.
+			file_lock(const std::string& filename) {
+#ifdef CHEBYSHEV_CACHE_POSIX
+				fd = ::open(filename.c_str(), O_CREAT | O_RDWR, 0644);
+
+				if(fd >= 0)
+					while(flock(fd, LOCK_EX) != 0 && errno == EINTR)
+						;
+#else
+				(void) filename;
+#endif
+			}
+
+			file_lock(const file_lock&) = delete;
+			file_lock& operator=(const file_lock&) = delete;
+
+			~file_lock() {
+#ifdef CHEBYSHEV_CACHE_POSIX
+				if(fd >= 0) {
+					flock(fd, LOCK_UN);
+					::close(fd);
+				}
+#endif
+			}
+		};
+
+
+		/// Create a temporary file next to the given file,
+		/// with a name which is unique to the process,
+		/// returning its name (empty if it could not be created).
+		inline std::string temporary(const std::string& filename) {
+
+#ifdef CHEBYSHEV_CACHE_POSIX
+			std::string tmp = filename + ".XXXXXX";
+			const int fd = mkstemp(&tmp[0]);
+
+			if(fd < 0)
+				return "";
+
+			fchmod(fd, 0644);
+			::close(fd);
+			return tmp;
+#else
+			return filename + ".tmp";
+#endif
+		}
+
+
+		/// Write the records updated by the current process to the
+		/// cache file, merging them with the records currently in the
+		/// file, which may have been written by other processes.
+		/// The merge is serialized between processes by a lock on the
+		/// ".lock" file next to the cache file, and the cache file is
+		/// replaced atomically by renaming a temporary file.
+		CHEBYSHEV_INLINE void save()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			if(!settings.enabled)
+				return;
+
+			std::lock_guard<std::mutex> lock (state.mutex);
+
+			if(state.updated.empty())
+				return;
+
+			const file_lock fileLock (settings.filename + ".lock");
+
+			std::map<std::string, record> records;
+			read(settings.filename, records);
+
+			for (const auto& p : state.updated)
+				records[p.first] = state.records[p.first];
+
+			const std::string tmp = temporary(settings.filename);
+			std::ofstream file (tmp);
+
+			if(!tmp.size() || !file.is_open()) {
+				std::cout << "Unable to write to cache file: " << settings.filename << std::endl;
+				return;
+			}
+
+			file << std::setprecision(std::numeric_limits<long double>::max_digits10);
+
+			for (const auto& p : records) {
+
+				file << p.first;
+
+				for (const auto& field : p.second)
+					file << '\t' << field.first << '=' << field.second;
+
+				file << '\n';
+			}
+
+			file.close();
+			std::rename(tmp.c_str(), settings.filename.c_str());
+			state.updated.clear();
+		}
+#endif
+
+
+		/// Construct the key of a test case from its name and
+		/// a string describing its options. The key also contains
+		/// the global and test case specific versions and, optionally,
+		/// the seed of the random module.
+		inline std::string key(const std::string& name, const std::string& options) {
+
+			std::string k = name + "|" + settings.version;
+
+			const auto it = settings.versions.find(name);
+			if(it != settings.versions.end())
+				k += "|" + it->second;
+
+			k += "|" + options;
+
+			if(settings.includeSeed)
+				k += "|seed=" + std::to_string(random::settings.seed);
+
+			// Tabs and newlines separate records
+			for (char& c : k)
+				if(c == '\t' || c == '\n')
+					c = ' ';
+
+			return k;
+		}
+
+
+		/// Describe the options of a precision estimate,
+		/// to be used as part of its key.
+		template<typename R, typename ...Args>
+		inline std::string describe(const prec::estimate_options<R, Args...>& opt) {
+
+			std::stringstream s;
+			s << std::setprecision(std::numeric_limits<long double>::max_digits10);
+
+			s << "domain=";
+			for (const prec::interval& i : opt.domain)
+				s << "[" << i.a << "," << i.b << "]";
+
+			s << ";iterations=" << opt.iterations;
+			s << ";tolerance=" << opt.tolerance;
+
+			// Types of the estimator and fail function
+			s << ";estimator=" << opt.estimator.target_type().name();
+			s << ";fail=" << opt.fail.target_type().name();
+
+			if(opt.tail.size) {
+				s << ";tail=" << opt.tail.size << "," << opt.tail.confidence
+					<< "," << opt.tail.resamples << "," << opt.tail.level
+					<< "," << opt.tail.extrapolation;
+			}
+
+			if(opt.early.failFast || opt.early.accept.size()) {
+				s << ";early=" << opt.early.failFast << "," << opt.early.accept
+					<< "," << opt.early.confidence << "," << opt.early.minIterations;
+			}
+
+			return s.str();
+		}
+
+
+		/// Convert an estimate result to a record.
+		inline record to_record(const prec::estimate_result& res) {
+
+			record r;
+			r["maxErr"] = res.maxErr;
+			r["meanErr"] = res.meanErr;
+			r["rmsErr"] = res.rmsErr;
+			r["relErr"] = res.relErr;
+			r["absErr"] = res.absErr;
+			r["iterations"] = res.iterations;
+
+			for (const auto& p : res.additionalFields)
+				r["+" + p.first] = p.second;
+
+			return r;
+		}
+
+
+		/// Convert a benchmark result to a record.
+		inline record to_record(const benchmark::benchmark_result& res) {
+
+			record r;
+			r["runs"] = res.runs;
+			r["iterations"] = res.iterations;
+			r["totalRuntime"] = res.totalRuntime;
+			r["averageRuntime"] = res.averageRuntime;
+			r["stdevRuntime"] = res.stdevRuntime;
+			r["runsPerSecond"] = res.runsPerSecond;
+			r["failed"] = res.failed;
+
+			for (const auto& p : res.additionalFields)
+				r["+" + p.first] = p.second;
+
+			return r;
+		}
+
+
+		/// Read the additional fields of a record, prefixed by "+".
+		template<typename ResultType>
+		inline void read_additional(const record& r, ResultType& res) {
+
+			for (const auto& p : r)
+				if(p.first.size() && p.first[0] == '+')
+					res.additionalFields[p.first.substr(1)] = p.second;
+		}
+
+
+		/// Convert a record to an estimate result.
+		inline void from_record(const record& r, prec::estimate_result& res) {
+
+			res.maxErr = r.at("maxErr");
+			res.meanErr = r.at("meanErr");
+			res.rmsErr = r.at("rmsErr");
+			res.relErr = r.at("relErr");
+			res.absErr = r.at("absErr");
+			res.iterations = r.at("iterations");
+			read_additional(r, res);
+		}
+
+
+		/// Convert a record to a benchmark result.
+		inline void from_record(const record& r, benchmark::benchmark_result& res) {
+
+			res.runs = r.at("runs");
+			res.iterations = r.at("iterations");
+			res.totalRuntime = r.at("totalRuntime");
+			res.averageRuntime = r.at("averageRuntime");
+			res.stdevRuntime = r.at("stdevRuntime");
+			res.runsPerSecond = r.at("runsPerSecond");
+			res.failed = r.at("failed");
+			read_additional(r, res);
+		}
+
+
+		/// Look up the cached result of a test case by key,
+		/// returning whether a valid result was found.
+		/// The result is marked as cached.
+		///
+		/// @param key The key of the test case
+		/// @param res The result to overwrite with the cached result
+		/// @return Whether a cached result was found
+		template<typename ResultType>
+		inline bool lookup(const std::string& key, ResultType& res) {
+
+			if(!settings.enabled)
+				return false;
+
+			load();
+
+			std::lock_guard<std::mutex> lock (state.mutex);
+
+			if(settings.force)
+				return false;
+
+			const auto it = state.records.find(key);
+
+			if(it == state.records.end())
+				return false;
+
+			try {
+				from_record(it->second, res);
+			} catch(std::out_of_range&) {
+				// Ignore incomplete records
+				return false;
+			}
+
+			res.cached = true;
+			return true;
+		}
+
+
+		/// Store the result of a test case in the cache.
+		///
+		/// @param key The key of the test case
+		/// @param res The result to store
+		template<typename ResultType>
+		inline void store(const std::string& key, const ResultType& res) {
+
+			if(!settings.enabled)
+				return;
+
+			load();
+
+			std::lock_guard<std::mutex> lock (state.mutex);
+			state.records[key] = to_record(res);
+			state.updated[key] = true;
+		}
+
+	}
+}
+
+#endif
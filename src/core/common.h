@@ -17,6 +17,21 @@
 #define CHEBYSHEV_PREC_TOLERANCE 1E-08
 #endif
 
+#ifndef CHEBYSHEV_PREC_ULP_TOLERANCE
+/// Default tolerance in ULPs in sweep estimation.
+#define CHEBYSHEV_PREC_ULP_TOLERANCE 1.0
+#endif
+
+#ifndef CHEBYSHEV_PREC_SHADOW_PERIOD
+/// Default sampling period of shadow precision sampling.
+#define CHEBYSHEV_PREC_SHADOW_PERIOD 1024
+#endif
+
+#ifndef CHEBYSHEV_PREC_SHADOW_MAX
+/// Maximum number of shadow samplers in a program.
+#define CHEBYSHEV_PREC_SHADOW_MAX 64
+#endif
+
 #ifndef CHEBYSHEV_BENCHMARK_ITER
 /// Default number of benchmark iterations.
 #define CHEBYSHEV_BENCHMARK_ITER 1000
@@ -27,14 +42,67 @@
 #define CHEBYSHEV_BENCHMARK_RUNS 10
 #endif
 
+#ifndef CHEBYSHEV_BENCHMARK_IN_FLIGHT
+/// Default maximum number of operations in flight
+/// in asynchronous benchmarks.
+#define CHEBYSHEV_BENCHMARK_IN_FLIGHT 16
+#endif
+
+#ifndef CHEBYSHEV_BENCHMARK_COLD_SAMPLES
+/// Default number of processes launched
+/// in cold-start benchmarks.
+#define CHEBYSHEV_BENCHMARK_COLD_SAMPLES 20
+#endif
+
+#ifndef CHEBYSHEV_SLOWEST
+/// Default number of the slowest test cases
+/// to report when terminating a module.
+#define CHEBYSHEV_SLOWEST 10
+#endif
+
+#ifndef CHEBYSHEV_TIME_LIMIT
+/// Default time limit on each test case
+/// in milliseconds (no limit if zero).
+#define CHEBYSHEV_TIME_LIMIT 0
+#endif
+
 #ifndef CHEBYSHEV_OUTPUT_WIDTH
 /// Default width of output columns
 #define CHEBYSHEV_OUTPUT_WIDTH 12
 #endif
 
 
+// Compiled library mode: when CHEBYSHEV_COMPILED is defined, the
+// global objects and the non-template functions of the framework are
+// only declared by the headers, and are defined once in the library
+// translation unit (src/chebyshev.cpp), which also defines
+// CHEBYSHEV_IMPLEMENTATION. Otherwise, the framework is header-only.
+#ifdef CHEBYSHEV_COMPILED
+
+/// Non-template functions are defined out of line.
+#define CHEBYSHEV_INLINE
+
+#ifndef CHEBYSHEV_IMPLEMENTATION
+
+/// Global objects are defined in the library.
+#define CHEBYSHEV_GLOBAL extern
+
+/// Definitions of non-template functions are skipped.
+#define CHEBYSHEV_DECLARATIONS_ONLY
+
+#else
+#define CHEBYSHEV_GLOBAL
+#endif
+
+#else
+#define CHEBYSHEV_INLINE inline
+#define CHEBYSHEV_GLOBAL
+#endif
+
+
 #include <limits>
 #include <vector>
+#include <functional>
 #include "../prec/interval.h"
 
 
@@ -0,0 +1,520 @@
+///
+/// @file metrics.h Live metrics in shared memory for external monitoring.
+///
+
+#ifndef CHEBYSHEV_METRICS_H
+#define CHEBYSHEV_METRICS_H
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstring>
+#include <cstdint>
+
+#include "./common.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CHEBYSHEV_METRICS_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+
+namespace chebyshev {
+
+	/// @namespace chebyshev::metrics Live metrics in shared memory
+	///
+	/// When enabled with the "--metrics=NAME" command line option or the
+	/// CHEBYSHEV_METRICS environment variable, the running counters of the
+	/// process (test cases run and failed by module, the current and latest
+	/// test case, the latest benchmark and its average runtime, and the
+	/// progress of the running estimator) are published in the POSIX shared
+	/// memory segment "/NAME" while the test suite runs. Worker processes
+	/// publish in the segment "/NAME.I", where I is the index of their shard.
+	///
+	/// The segment has a fixed, versioned layout and is updated under a
+	/// sequence lock, so that it may be read by a separate monitoring process
+	/// (e.g. examples/metrics_viewer.cpp) without any system call, lock or
+	/// other interaction with the process under test, which only performs
+	/// a few stores to memory for each update. The segment is left in place
+	/// when the process exits, so that its final state may still be read,
+	/// and is reset by the next process which opens it.
+	namespace metrics {
+
+
+		/// Magic number at the start of a metrics segment ("CHBY").
+		constexpr uint32_t magic = 0x59424843;
+
+		/// Version of the layout of the metrics segment.
+		constexpr uint32_t version = 1;
+
+
+		/// @class metrics_data
+		/// The metrics published by a process, which are copied
+		/// as a whole by readers of the segment.
+		struct metrics_data {
+
+			/// Process identifier of the writer.
+			uint32_t pid;
+
+			/// Whether a module is currently running
+			/// (set up but not yet terminated).
+			uint32_t running;
+
+			/// Total number of updates to the metrics.
+			uint64_t updates;
+
+			/// Total number of precision tests run by the process.
+			uint64_t totalTests;
+
+			/// Number of failed precision tests.
+			uint64_t failedTests;
+
+			/// Total number of benchmarks run by the process.
+			uint64_t totalBenchmarks;
+
+			/// Number of failed benchmarks.
+			uint64_t failedBenchmarks;
+
+			/// Total number of error checks run by the process.
+			uint64_t totalChecks;
+
+			/// Number of failed error checks.
+			uint64_t failedChecks;
+
+			/// Number of completed steps of the running estimator
+			/// (e.g. subdomains estimated).
+			uint64_t progressDone;
+
+			/// Number of steps of the running estimator known
+			/// so far (zero if the progress is not known).
+			uint64_t progressTotal;
+
+			/// Average runtime of the latest benchmark in milliseconds.
+			double averageRuntime;
+
+			/// Name of the module under test.
+			char module[64];
+
+			/// Name of the running test case (empty if none).
+			char current[128];
+
+			/// Name of the latest completed test case.
+			char latest[128];
+
+			/// Name of the latest completed benchmark.
+			char benchmark[128];
+
+		};
+
+
+		/// @class metrics_segment
+		/// Layout of the shared memory segment.
+		struct metrics_segment {
+
+			/// Magic number identifying the segment.
+			uint32_t magic;
+
+			/// Version of the layout.
+			uint32_t version;
+
+			/// Size of the segment in bytes.
+			uint32_t size;
+
+			/// Reserved for future use.
+			uint32_t reserved;
+
+			/// Sequence counter of the lock, which is odd while
+			/// the metrics are being updated.
+			std::atomic<uint64_t> sequence;
+
+			/// The published metrics.
+			metrics_data data;
+
+		};
+
+
+		/// @class metrics_settings
+		/// Global settings of live metrics.
+		struct metrics_settings {
+
+			/// Name of the shared memory segment
+			/// (live metrics are disabled if empty).
+			std::string name = "";
+
+		};
+
+
+		/// Global settings of live metrics.
+		CHEBYSHEV_GLOBAL metrics_settings settings;
+
+
+		/// @class metrics_state
+		/// The open metrics segment of the process.
+		struct metrics_state {
+
+			/// The mapped segment (nullptr if not open).
+			std::atomic<metrics_segment*> segment {nullptr};
+
+			/// Name of the open segment.
+			std::string name = "";
+
+			/// Serializes the threads of the process which open, close
+			/// or update the segment, as the sequence lock only allows
+			/// a single writer.
+			std::mutex mutex;
+
+		};
+
+
+		/// Global state of live metrics.
+		CHEBYSHEV_GLOBAL metrics_state state;
+
+
+		/// Returns the name of a shared memory segment,
+		/// prefixed by a slash if needed.
+		inline std::string segment_name(const std::string& name) {
+			return (name.size() && name[0] == '/') ? name : ("/" + name);
+		}
+
+
+		/// Copy a string into a fixed size field of the segment,
+		/// truncating it if needed.
+		template<size_t N>
+		inline void copy_name(char (&dest)[N], const char* src) {
+
+			size_t i = 0;
+			for (; i < N - 1 && src[i]; ++i)
+				dest[i] = src[i];
+
+			dest[i] = '\0';
+		}
+
+
+		/// Open a shared memory segment and start publishing
+		/// live metrics to it, returning whether it was opened.
+		/// A segment which is already open is closed first.
+		///
+		/// @param name The name of the segment
+		CHEBYSHEV_INLINE bool open(const std::string& name)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+#ifdef CHEBYSHEV_METRICS_POSIX
+
+			std::lock_guard<std::mutex> lock (state.mutex);
+
+			if(state.segment && state.name == segment_name(name))
+				return true;
+
+			if(state.segment) {
+				munmap(state.segment, sizeof(metrics_segment));
+				state.segment = nullptr;
+			}
+
+			const std::string path = segment_name(name);
+			const int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0644);
+
+			if(fd < 0)
+				return false;
+
+			if(ftruncate(fd, sizeof(metrics_segment)) != 0) {
+				::close(fd);
+				return false;
+			}
+
+			void* ptr = mmap(nullptr, sizeof(metrics_segment),
+				PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			::close(fd);
+
+			if(ptr == MAP_FAILED)
+				return false;
+
+			// Invalidate the segment while resetting it, so that
+			// readers do not accept a partially written layout
+			metrics_segment* s = static_cast<metrics_segment*>(ptr);
+			s->magic = 0;
+			std::atomic_thread_fence(std::memory_order_release);
+
+			s = new (ptr) metrics_segment();
+			s->data.pid = getpid();
+			s->version = version;
+			s->size = sizeof(metrics_segment);
+			s->sequence.store(0, std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_release);
+			s->magic = magic;
+
+			state.segment = s;
+			state.name = path;
+			return true;
+#else
+			return false;
+#endif
+		}
+#endif
+
+
+		/// Stop publishing live metrics, leaving the segment in place.
+		CHEBYSHEV_INLINE void close()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			std::lock_guard<std::mutex> lock (state.mutex);
+
+#ifdef CHEBYSHEV_METRICS_POSIX
+			if(state.segment)
+				munmap(state.segment, sizeof(metrics_segment));
+#endif
+
+			state.segment = nullptr;
+			state.name = "";
+		}
+#endif
+
+
+		/// Remove a shared memory segment, returning whether it was removed.
+		///
+		/// @param name The name of the segment
+		CHEBYSHEV_INLINE bool remove(const std::string& name)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+#ifdef CHEBYSHEV_METRICS_POSIX
+			return shm_unlink(segment_name(name).c_str()) == 0;
+#else
+			return false;
+#endif
+		}
+#endif
+
+
+		/// Update the published metrics with a function taking
+		/// a reference to the metrics_data of the segment.
+		/// Does nothing if no segment is open.
+		///
+		/// @param f The function which updates the metrics
+		template<typename Function>
+		inline void update(Function f) {
+
+			if(!state.segment.load(std::memory_order_acquire))
+				return;
+
+			std::lock_guard<std::mutex> lock (state.mutex);
+			metrics_segment* s = state.segment;
+
+			if(!s)
+				return;
+
+			// Make the sequence odd before writing the metrics
+			const uint64_t seq = s->sequence.load(std::memory_order_relaxed);
+			s->sequence.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			f(s->data);
+			s->data.updates++;
+
+			s->sequence.store(seq + 2, std::memory_order_release);
+		}
+
+
+		/// Publish the start of a module.
+		///
+		/// @param moduleName The name of the module under test
+		inline void begin(const std::string& moduleName) {
+
+			update([&](metrics_data& data) {
+				copy_name(data.module, moduleName.c_str());
+				data.running = 1;
+			});
+		}
+
+
+		/// Publish the termination of a module.
+		inline void end() {
+
+			update([](metrics_data& data) {
+				data.running = 0;
+				data.current[0] = '\0';
+			});
+		}
+
+
+		/// Publish the start of a test case.
+		///
+		/// @param name The name of the test case
+		inline void start(const std::string& name) {
+
+			update([&](metrics_data& data) {
+				copy_name(data.current, name.c_str());
+				data.progressDone = 0;
+				data.progressTotal = 0;
+			});
+		}
+
+
+		/// Publish the progress of the running estimator.
+		///
+		/// @param done The number of completed steps
+		/// @param total The number of steps known so far
+		inline void progress(uint64_t done, uint64_t total) {
+
+			update([=](metrics_data& data) {
+				data.progressDone = done;
+				data.progressTotal = total;
+			});
+		}
+
+
+		/// Publish the result of a test case.
+		///
+		/// @param module The module of the test case
+		/// ("prec", "benchmark" or "err")
+		/// @param name The name of the test case
+		/// @param failed Whether the test case failed
+		inline void test_case(const char* module, const char* name, bool failed) {
+
+			update([&](metrics_data& data) {
+
+				if(module[0] == 'p') {
+					data.totalTests++;
+					data.failedTests += failed;
+				} else if(module[0] == 'b') {
+					data.totalBenchmarks++;
+					data.failedBenchmarks += failed;
+				} else {
+					data.totalChecks++;
+					data.failedChecks += failed;
+				}
+
+				copy_name(data.latest, name);
+				data.current[0] = '\0';
+			});
+		}
+
+
+		/// Publish the result of a test case.
+		///
+		/// @param module The module of the test case
+		/// ("prec", "benchmark" or "err")
+		/// @param name The name of the test case
+		/// @param failed Whether the test case failed
+		inline void test_case(const char* module, const std::string& name, bool failed) {
+			test_case(module, name.c_str(), failed);
+		}
+
+
+		/// Publish the result of a benchmark.
+		///
+		/// @param name The name of the benchmark
+		/// @param averageRuntime The average runtime in milliseconds
+		/// @param failed Whether the benchmark failed
+		inline void benchmark_case(const std::string& name, long double averageRuntime, bool failed) {
+
+			update([&](metrics_data& data) {
+
+				data.totalBenchmarks++;
+				data.failedBenchmarks += failed;
+				data.averageRuntime = averageRuntime;
+
+				copy_name(data.latest, name.c_str());
+				copy_name(data.benchmark, name.c_str());
+				data.current[0] = '\0';
+			});
+		}
+
+
+		/// Open a metrics segment for reading, returning nullptr
+		/// if it does not exist or its layout is not supported.
+		///
+		/// @param name The name of the segment
+		CHEBYSHEV_INLINE const metrics_segment* attach(const std::string& name)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+#ifdef CHEBYSHEV_METRICS_POSIX
+
+			const int fd = shm_open(segment_name(name).c_str(), O_RDONLY, 0);
+
+			if(fd < 0)
+				return nullptr;
+
+			void* ptr = mmap(nullptr, sizeof(metrics_segment), PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+
+			if(ptr == MAP_FAILED)
+				return nullptr;
+
+			const metrics_segment* s = static_cast<const metrics_segment*>(ptr);
+
+			if(s->magic != magic || s->version != version || s->size != sizeof(metrics_segment)) {
+				munmap(ptr, sizeof(metrics_segment));
+				return nullptr;
+			}
+
+			return s;
+#else
+			return nullptr;
+#endif
+		}
+#endif
+
+
+		/// Close a metrics segment opened for reading.
+		///
+		/// @param s The segment returned by attach
+		CHEBYSHEV_INLINE void detach(const metrics_segment* s)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+#ifdef CHEBYSHEV_METRICS_POSIX
+			if(s)
+				munmap(const_cast<metrics_segment*>(s), sizeof(metrics_segment));
+#endif
+		}
+#endif
+
+
+		/// Read a consistent copy of the metrics of a segment,
+		/// retrying while the writer is updating them. Returns
+		/// whether a consistent copy was read within the given
+		/// number of attempts.
+		///
+		/// @param s The segment returned by attach
+		/// @param data The metrics_data to copy the metrics to
+		/// @param attempts The maximum number of attempts
+		inline bool read(const metrics_segment* s, metrics_data& data, unsigned int attempts = 1000) {
+
+			for (unsigned int i = 0; i < attempts; ++i) {
+
+				const uint64_t before = s->sequence.load(std::memory_order_acquire);
+
+				if(before & 1)
+					continue;
+
+				std::memcpy(&data, &s->data, sizeof(metrics_data));
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if(s->sequence.load(std::memory_order_relaxed) == before)
+					return true;
+			}
+
+			return false;
+		}
+
+	}
+}
+
+#endif
@@ -11,6 +11,9 @@
 #include <map>
 #include <sstream>
 #include <iomanip>
+#include <fstream>
+#include <iostream>
+#include <functional>
 
 #include "../prec/prec_structures.h"
 #include "../benchmark/benchmark_structures.h"
@@ -91,7 +94,12 @@ namespace chebyshev {
 			/// Whether the output module was setup.
 			bool wasSetup = false;
 
-		} settings;
+		};
+
+
+		/// Settings of the output module, including the open
+		/// output files, local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local output_settings settings;
 
 
 		/// A function which converts the table entries of a row
@@ -117,7 +125,11 @@ namespace chebyshev {
 
 			/// Bare bone output format which just prints the result
 			/// table as is, without any formatting beyond adjusting column width.
-			inline OutputFormat barebone() {
+			CHEBYSHEV_INLINE OutputFormat barebone()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+			;
+#else
+			{
 
 				return [](
 					const std::vector<std::vector<std::string>>& table,
@@ -158,6 +170,7 @@ namespace chebyshev {
 					return result.str();
 				};
 			}
+#endif
 
 
 			/// Simple output format which prints the fields
@@ -165,7 +178,11 @@ namespace chebyshev {
 			/// The OutputFormat is returned as a lambda function.
 			/// This format is a good starting point if you want to implement
 			/// your own custom output format.
-			inline OutputFormat simple() {
+			CHEBYSHEV_INLINE OutputFormat simple()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+			;
+#else
+			{
 
 				return [](
 					const std::vector<std::vector<std::string>>& table,
@@ -228,12 +245,17 @@ namespace chebyshev {
 						+ decoration;
 				};
 			}
+#endif
 
 
 			/// Fancy output format which uses Unicode characters
 			/// to print a continuous outline around the table.
 			/// The OutputFormat is returned as a lambda function.
-			inline OutputFormat fancy(bool adaptiveWidth = true) {
+			CHEBYSHEV_INLINE OutputFormat fancy(bool adaptiveWidth = true)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+			;
+#else
+			{
 
 				return [adaptiveWidth](
 					const std::vector<std::vector<std::string>>& table,
@@ -355,6 +377,7 @@ namespace chebyshev {
 					return header + result.str() + underline;
 				};
 			}
+#endif
 
 
 			/// Format function for CSV format files.
@@ -362,7 +385,11 @@ namespace chebyshev {
 			///
 			/// @param separator The string to print between
 			/// different fields (defaults to ",").
-			inline OutputFormat csv(const std::string& separator = ",") {
+			CHEBYSHEV_INLINE OutputFormat csv(const std::string& separator = ",")
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+			;
+#else
+			{
 
 				return [separator](
 					const std::vector<std::vector<std::string>>& table,
@@ -399,11 +426,16 @@ namespace chebyshev {
 					return s.str();
 				};
 			}
+#endif
 
 
 			/// Format the table as Markdown.
 			/// The OutputFormat is returned as a lambda function.
-			inline OutputFormat markdown() {
+			CHEBYSHEV_INLINE OutputFormat markdown()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+			;
+#else
+			{
 
 				return [](
 					const std::vector<std::vector<std::string>>& table,
@@ -468,11 +500,16 @@ namespace chebyshev {
 					return header + "\n" + decoration + result.str();
 				};
 			}
+#endif
 
 
 			/// Format the table as a LaTeX table in the tabular environment.
 			/// The OutputFormat is returned as a lambda function.
-			inline OutputFormat latex() {
+			CHEBYSHEV_INLINE OutputFormat latex()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+			;
+#else
+			{
 
 				return [=](
 					const std::vector<std::vector<std::string>>& table,
@@ -531,12 +568,17 @@ namespace chebyshev {
 					return result.str();
 				};
 			}
+#endif
 
 		}
 
 
 		/// Setup printing to the output stream with default options.
-		inline void setup() {
+		CHEBYSHEV_INLINE void setup()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			// Skip subsequent setup calls
 			if (settings.wasSetup)
@@ -552,11 +594,36 @@ namespace chebyshev {
 			settings.fieldNames["tolerance"] = "Tolerance";
 			settings.fieldNames["failed"] = "Result";
 			settings.fieldNames["iterations"] = "Iterations";
+			settings.fieldNames["cached"] = "Cached";
+			settings.fieldNames["wallTime"] = "Wall Time (ms)";
+			settings.fieldNames["share"] = "Share";
+			settings.fieldNames["maxUlp"] = "Max ULP";
+			settings.fieldNames["meanUlp"] = "Mean ULP";
+			settings.fieldNames["subdomains"] = "Subdomains";
+			settings.fieldNames["refinements"] = "Refinements";
+			settings.fieldNames["worstInput"] = "Worst Input";
+			settings.fieldNames["samples"] = "Samples";
+			settings.fieldNames["dropped"] = "Dropped";
+			settings.fieldNames["proven"] = "Proven";
+			settings.fieldNames["boundErr"] = "Bound Err.";
+			settings.fieldNames["meanAbs"] = "Mean Abs.";
+			settings.fieldNames["tailMax"] = "Tail Max Err.";
+			settings.fieldNames["tailBound"] = "Tail Bound";
+			settings.fieldNames["tailShape"] = "Tail Shape";
+			settings.fieldNames["tailSamples"] = "Tail Samples";
 
 			// Equation fields
 			settings.fieldNames["difference"] = "Difference";
 			settings.fieldNames["evaluated"] = "Evaluated";
 			settings.fieldNames["expected"] = "Expected";
+			settings.fieldNames["count"] = "Count";
+			settings.fieldNames["failures"] = "Failures";
+			settings.fieldNames["maxDiff"] = "Max Diff.";
+			settings.fieldNames["meanDiff"] = "Mean Diff.";
+			settings.fieldNames["worstIndex"] = "Worst Index";
+			settings.fieldNames["residual"] = "Residual";
+			settings.fieldNames["backwardError"] = "Backward Err.";
+			settings.fieldNames["orthogonality"] = "Orthogonality";
 
 			// Benchmark fields
 			settings.fieldNames["totalRuntime"] = "Tot. Time (ms)";
@@ -564,6 +631,23 @@ namespace chebyshev {
 			settings.fieldNames["stdevRuntime"] = "Stdev. Time (ms)";
 			settings.fieldNames["runsPerSecond"] = "Runs per Sec.";
 			settings.fieldNames["runs"] = "Runs";
+			settings.fieldNames["slowdown"] = "Slowdown";
+			settings.fieldNames["errorRate"] = "Error Rate";
+			settings.fieldNames["depth"] = "Depth";
+			settings.fieldNames["baseline"] = "Baseline (ms)";
+			settings.fieldNames["unwindCost"] = "Unwind Cost (ms)";
+			settings.fieldNames["submitCost"] = "Submit Cost (ms)";
+			settings.fieldNames["latencyP50"] = "P50 Lat. (ms)";
+			settings.fieldNames["latencyP90"] = "P90 Lat. (ms)";
+			settings.fieldNames["latencyP99"] = "P99 Lat. (ms)";
+			settings.fieldNames["latencyMax"] = "Max Lat. (ms)";
+			settings.fieldNames["inFlight"] = "In Flight";
+			settings.fieldNames["firstCallP50"] = "P50 First (ms)";
+			settings.fieldNames["firstCallP90"] = "P90 First (ms)";
+			settings.fieldNames["firstCallMax"] = "Max First (ms)";
+			settings.fieldNames["firstCalls"] = "First K (ms)";
+			settings.fieldNames["steadyRuntime"] = "Steady (ms)";
+			settings.fieldNames["coldRatio"] = "Cold Ratio";
 
 			// Error checking
 			settings.fieldNames["correctType"] = "Correct Type";
@@ -591,17 +675,44 @@ namespace chebyshev {
 
 			settings.wasSetup = true;
 		}
+#endif
+
+
+		/// Copy the formatting options of the output module (field names
+		/// and options, column width, precision and output formats),
+		/// without the output files, e.g. to format results in the
+		/// same way from another thread.
+		///
+		/// @param dest The settings to copy the options to
+		/// @param src The settings to copy the options from
+		inline void copy_format(output_settings& dest, const output_settings& src) {
+
+			dest.fieldNames = src.fieldNames;
+			dest.fieldOptions = src.fieldOptions;
+			dest.defaultColumnWidth = src.defaultColumnWidth;
+			dest.outputPrecision = src.outputPrecision;
+			dest.outputFormat = src.outputFormat;
+			dest.defaultFileOutputFormat = src.defaultFileOutputFormat;
+			dest.fileOutputFormat = src.fileOutputFormat;
+			dest.quiet = src.quiet;
+			dest.wasSetup = src.wasSetup;
+		}
 
 
 		/// Terminate the output module by closing all output files
 		/// and resetting its settings.
-		inline void terminate() {
+		CHEBYSHEV_INLINE void terminate()
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			// Close all open files
 			for (auto& file_pair : settings.openFiles)
 				if(file_pair.second.is_open())
 					file_pair.second.close();
 		}
+#endif
 
 
 		/// Resolve the field of an estimate result by name,
@@ -609,8 +720,12 @@ namespace chebyshev {
 		///
 		/// @param fieldName The name of the field to resolve
 		/// @param r The estimate result to read the fields of
-		inline std::string resolve_field(
-			const std::string& fieldName, prec::estimate_result r) {
+		CHEBYSHEV_INLINE std::string resolve_field(
+			const std::string& fieldName, prec::estimate_result r)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			std::stringstream value;
 
@@ -642,6 +757,12 @@ namespace chebyshev {
 					<< r.tolerance;
 			} else if(fieldName == "failed") {
 				value << r.failed;
+			} else if(fieldName == "cached") {
+				value << r.cached;
+			} else if(fieldName == "iterations") {
+				value << r.iterations;
+			} else if(fieldName == "wallTime") {
+				value << r.wallTime;
 			} else {
 				
 				if(r.additionalFields.find(fieldName) == r.additionalFields.end())
@@ -652,6 +773,7 @@ namespace chebyshev {
 
 			return value.str();
 		}
+#endif
 
 
 		/// Resolve the field of an equation result by name,
@@ -659,8 +781,12 @@ namespace chebyshev {
 		///
 		/// @param fieldName The name of the field to resolve
 		/// @param r The equation result to read the fields of
-		inline std::string resolve_field(
-			const std::string& fieldName, prec::equation_result r) {
+		CHEBYSHEV_INLINE std::string resolve_field(
+			const std::string& fieldName, prec::equation_result r)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			std::stringstream value;
 
@@ -680,6 +806,8 @@ namespace chebyshev {
 					<< r.tolerance;
 			} else if(fieldName == "failed") {
 				value << r.failed;
+			} else if(fieldName == "wallTime") {
+				value << r.wallTime;
 			} else {
 				
 				if(r.additionalFields.find(fieldName) == r.additionalFields.end())
@@ -690,12 +818,17 @@ namespace chebyshev {
 
 			return value.str();
 		}
+#endif
 
 
 		/// Resolve the field of a benchmark result by name,
 		/// returning the value as a string.
-		inline std::string resolve_field(
-			const std::string& fieldName, benchmark::benchmark_result r) {
+		CHEBYSHEV_INLINE std::string resolve_field(
+			const std::string& fieldName, benchmark::benchmark_result r)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			std::stringstream value;
 
@@ -724,6 +857,10 @@ namespace chebyshev {
 					value << r.runsPerSecond;
 			} else if(fieldName == "failed") {
 				value << r.failed;
+			} else if(fieldName == "cached") {
+				value << r.cached;
+			} else if(fieldName == "wallTime") {
+				value << r.wallTime;
 			} else {
 				
 				if(r.additionalFields.find(fieldName) == r.additionalFields.end())
@@ -734,6 +871,7 @@ namespace chebyshev {
 
 			return value.str();
 		}
+#endif
 
 
 		/// Resolve the field of an assertion result by name,
@@ -741,8 +879,12 @@ namespace chebyshev {
 		///
 		/// @param fieldName The name of the field to resolve
 		/// @param r The assertion result to read the fields of
-		inline std::string resolve_field(
-			const std::string& fieldName, err::assert_result r) {
+		CHEBYSHEV_INLINE std::string resolve_field(
+			const std::string& fieldName, err::assert_result r)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			std::stringstream value;
 
@@ -754,12 +896,15 @@ namespace chebyshev {
 				value << r.description;
 			} else if(fieldName == "failed") {
 				value << r.failed;
+			} else if(fieldName == "wallTime") {
+				value << r.wallTime;
 			} else {
 				return "";
 			}
 
 			return value.str();
 		}
+#endif
 
 
 		/// Resolve the field of an errno checking result by name,
@@ -767,8 +912,12 @@ namespace chebyshev {
 		///
 		/// @param fieldName The name of the field to resolve
 		/// @param r The errno checking result to read the fields of
-		inline std::string resolve_field(
-			const std::string& fieldName, err::errno_result r) {
+		CHEBYSHEV_INLINE std::string resolve_field(
+			const std::string& fieldName, err::errno_result r)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			std::stringstream value;
 
@@ -786,12 +935,15 @@ namespace chebyshev {
 
 			} else if(fieldName == "failed") {
 				value << r.failed;
+			} else if(fieldName == "wallTime") {
+				value << r.wallTime;
 			} else {
 				return "";
 			}
 
 			return value.str();
 		}
+#endif
 
 
 		/// Resolve the field of an exception checking result by name,
@@ -799,8 +951,12 @@ namespace chebyshev {
 		///
 		/// @param fieldName The name of the field to resolve
 		/// @param r The exception checking result to read the fields of
-		inline std::string resolve_field(
-			const std::string& fieldName, err::exception_result r) {
+		CHEBYSHEV_INLINE std::string resolve_field(
+			const std::string& fieldName, err::exception_result r)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			std::stringstream value;
 
@@ -812,12 +968,15 @@ namespace chebyshev {
 				value << r.correctType;
 			} else if(fieldName == "failed") {
 				value << r.failed;
+			} else if(fieldName == "wallTime") {
+				value << r.wallTime;
 			} else {
 				return "";
 			}
 
 			return value.str();
 		}
+#endif
 
 
 		/// Generate a table of results as a string matrix to pass to
@@ -877,7 +1036,11 @@ namespace chebyshev {
 		///
 		/// @param filename The name of the file
 		/// @return Whether the file was correctly opened or not
-		inline bool open_file(std::string filename) {
+		CHEBYSHEV_INLINE bool open_file(std::string filename)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			const auto file_pair = settings.openFiles.find(filename);
 
@@ -894,6 +1057,7 @@ namespace chebyshev {
 
 			return true;
 		}
+#endif
 
 
 		/// Print the test results to standard output and output files
@@ -962,6 +1126,37 @@ namespace chebyshev {
 				std::cout << "Results have been saved in: " << filename << std::endl;
 			}
 		}
+
+
+#ifdef CHEBYSHEV_COMPILED
+
+		// Instantiations for the result types of the modules,
+		// defined in the compiled library.
+		extern template void print_results(
+			const std::map<std::string, std::vector<prec::estimate_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		extern template void print_results(
+			const std::map<std::string, std::vector<prec::equation_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		extern template void print_results(
+			const std::map<std::string, std::vector<benchmark::benchmark_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		extern template void print_results(
+			const std::map<std::string, std::vector<err::assert_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		extern template void print_results(
+			const std::map<std::string, std::vector<err::errno_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+		extern template void print_results(
+			const std::map<std::string, std::vector<err::exception_result>>&,
+			const std::vector<std::string>&, const std::vector<std::string>&);
+
+#endif
 	}
 }
 
@@ -7,7 +7,15 @@
 #define CHEBYSHEV_RANDOM_H
 
 #include <cstdlib>
+#include <cstdint>
+#include <atomic>
 #include <cmath>
+#include <ctime>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
 #include "../core/common.h"
 
 
@@ -25,23 +33,145 @@ namespace chebyshev {
 			/// The seed for random number generation
 			uint64_t seed = 0;
 
-		} settings;
+		};
 
 
-		/// Initialize the random module.
+		/// Settings of the random module,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local random_settings settings;
+
+
+		/// Advance a SplitMix64 state and return the next
+		/// number of its sequence, used to seed other generators.
+		inline uint64_t splitmix64(uint64_t& x) {
+
+			uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+
+		/// @class xoshiro256
+		/// The xoshiro256** pseudorandom number generator, a fast
+		/// 64-bit engine used by the bulk generators of the module.
+		/// It satisfies the UniformRandomBitGenerator requirements,
+		/// so it may be used with the standard library algorithms.
+		struct xoshiro256 {
+
+			using result_type = uint64_t;
+
+			/// State of the generator, which must not be all zero.
+			uint64_t s[4];
+
+
+			/// Construct a generator with a different seed for each
+			/// generator constructed by the process, so that the engines
+			/// of different threads draw different sequences until seeded.
+			xoshiro256() {
+				static std::atomic<uint64_t> generators {0};
+				seed(++generators);
+			}
+
+
+			/// Construct a generator from a seed.
+			xoshiro256(uint64_t seed) {
+				this->seed(seed);
+			}
+
+
+			/// Seed the generator, expanding the seed with SplitMix64.
+			inline void seed(uint64_t seed) {
+
+				for (int i = 0; i < 4; ++i)
+					s[i] = splitmix64(seed);
+			}
+
+
+			/// Generate the next 64-bit number.
+			inline uint64_t operator()() {
+
+				const uint64_t result = rotl(s[1] * 5, 7) * 9;
+				const uint64_t t = s[1] << 17;
+
+				s[2] ^= s[0];
+				s[3] ^= s[1];
+				s[1] ^= s[2];
+				s[0] ^= s[3];
+				s[2] ^= t;
+				s[3] = rotl(s[3], 45);
+
+				return result;
+			}
+
+
+			static constexpr uint64_t min() {
+				return 0;
+			}
+
+
+			static constexpr uint64_t max() {
+				return UINT64_MAX;
+			}
+
+			private:
+
+			static inline uint64_t rotl(uint64_t x, int k) {
+				return (x << k) | (x >> (64 - k));
+			}
+		};
+
+
+		/// Engine of the bulk generators, local to each thread
+		/// (see chebyshev::context) and seeded by random::setup().
+		CHEBYSHEV_GLOBAL thread_local xoshiro256 engine;
+
+
+		/// Initialize the random module. If no seed is given,
+		/// the seed depends on the current time and, after the first
+		/// setup, on the number of setups, so that contexts which are
+		/// setup at the same time draw different sequences.
+		/// All generators of the module draw from the engine of the
+		/// calling thread, so that each context has its own sequence.
 		inline void setup(uint64_t seed = 0) {
 
+			static std::atomic<uint64_t> setups {0};
+
 			if(seed == 0)
-				seed = time(nullptr);
+				seed = time(nullptr) + (setups++ << 32);
 
 			settings.seed = seed;
-			srand(settings.seed);
+			engine.seed(settings.seed);
+		}
+
+
+		/// Draw seeds for the engines of parallel tasks from the
+		/// engine of the calling thread, so that tasks running on
+		/// other threads draw sequences determined by the seed
+		/// given to random::setup().
+		///
+		/// @param count The number of tasks
+		inline std::vector<uint64_t> seeds(size_t count) {
+
+			std::vector<uint64_t> res (count);
+
+			for (size_t i = 0; i < count; ++i)
+				res[i] = engine();
+
+			return res;
 		}
 
 
 		/// Generate a random natural number.
 		inline uint64_t natural() {
-			return rand();
+			return engine();
+		}
+
+
+		/// Generate a real number uniformly distributed
+		/// over [0, 1) with 53 random bits, using the fast engine.
+		inline double real() {
+			return (engine() >> 11) * (1.0 / 9007199254740992.0);
 		}
 
 
@@ -50,9 +180,115 @@ namespace chebyshev {
 		/// @param a The lower extreme of the interval
 		/// @param b The upper extreme of the interval
 		/// @return A pseudorandom number uniformly
-		/// distributed over (a, b).
+		/// distributed over [a, b).
 		inline long double uniform(long double a, long double b) {
-			return (rand() / (long double) RAND_MAX) * (b - a) + a;
+			return real() * (b - a) + a;
+		}
+
+
+		/// Generate a natural number uniformly distributed
+		/// over [0, n) using the fast engine, without the bias
+		/// of the modulo operation (Lemire's method).
+		///
+		/// @param n The upper extreme of the range, which must be positive.
+		inline uint64_t bounded(uint64_t n) {
+
+			if(n <= UINT32_MAX) {
+
+				uint64_t m = (engine() >> 32) * n;
+
+				if((uint32_t) m < n) {
+
+					const uint32_t threshold = (uint32_t) (-n) % n;
+
+					while((uint32_t) m < threshold)
+						m = (engine() >> 32) * n;
+				}
+
+				return m >> 32;
+			}
+
+			// Rejection of the incomplete last interval
+			const uint64_t threshold = (-n) % n;
+			uint64_t x = engine();
+
+			while(x < threshold)
+				x = engine();
+
+			return x % n;
+		}
+
+
+		/// Fill a buffer with random bytes from the fast engine.
+		///
+		/// @param buffer The buffer to fill
+		/// @param size The size of the buffer in bytes
+		inline void fill_bytes(void* buffer, size_t size) {
+
+			unsigned char* bytes = static_cast<unsigned char*>(buffer);
+			size_t i = 0;
+
+			for (; i + 8 <= size; i += 8) {
+				const uint64_t x = engine();
+				std::memcpy(bytes + i, &x, 8);
+			}
+
+			if(i < size) {
+				const uint64_t x = engine();
+				std::memcpy(bytes + i, &x, size - i);
+			}
+		}
+
+
+		/// Fill a buffer with characters chosen uniformly from an alphabet
+		/// of at most 65536 elements, without modulo bias. Each call to
+		/// the engine provides four characters, by mapping each 16-bit
+		/// chunk to the alphabet with a multiplication and rejecting
+		/// the chunks falling in the incomplete last interval.
+		///
+		/// @param buffer The buffer to fill
+		/// @param length The number of characters to generate
+		/// @param alphabet The elements of the alphabet
+		/// @param size The number of elements of the alphabet
+		inline void fill_string(
+			char* buffer, size_t length, const char* alphabet, size_t size) {
+
+			if(!size || size > 65536)
+				throw std::runtime_error(
+					"alphabet size in chebyshev::random::fill_string must be in [1, 65536].");
+
+			// Alphabets whose size is a power of two only need a mask
+			if(!(size & (size - 1))) {
+
+				const uint64_t mask = size - 1;
+				size_t i = 0;
+
+				while(i < length) {
+
+					const uint64_t x = engine();
+
+					for (int k = 0; k < 4 && i < length; ++k)
+						buffer[i++] = alphabet[(x >> (16 * k)) & mask];
+				}
+
+				return;
+			}
+
+			const uint32_t threshold = (65536 - size) % size;
+			size_t i = 0;
+
+			while(i < length) {
+
+				const uint64_t x = engine();
+
+				for (int k = 0; k < 4 && i < length; ++k) {
+
+					const uint32_t m = ((x >> (16 * k)) & 0xFFFF) * (uint32_t) size;
+
+					if((m & 0xFFFF) >= threshold)
+						buffer[i++] = alphabet[m >> 16];
+				}
+			}
 		}
 
 
@@ -69,7 +305,7 @@ namespace chebyshev {
 				throw std::runtime_error(
 					"Vector and domain size mismatch in chebyshev::sample_uniform");
 
-			for (int i = 0; i < x.size(); ++i)
+			for (size_t i = 0; i < x.size(); ++i)
 				x[i] = uniform(intervals[i].a, intervals[i].b);
 		
 			return x;
@@ -83,8 +319,8 @@ namespace chebyshev {
 		/// @return A pseudorandom number Gaussian distributed.
 		inline long double gaussian(long double m, long double s) {
 
-			const long double x = uniform(0.0, 1.0);
-			const long double y = uniform(0.0, 1.0);
+			const long double x = 1 - real();
+			const long double y = real();
 
 			const long double v = std::sqrt(-2 * std::log(x));
 			const long double u = v * std::cos(2 * PI_CONST * y);
@@ -101,11 +337,16 @@ namespace chebyshev {
 		/// of the alphabet with uniform probability.
 		inline std::string string(size_t length) {
 
+			static const std::string printable = []() {
+				std::string str (95, ' ');
+				for (int i = 0; i < 95; ++i)
+					str[i] = '!' + i;
+				return str;
+			}();
+
 			std::string str;
 			str.resize(length);
-
-			for (unsigned int i = 0; i < length; ++i)
-				str[i] = '!' + (char) (natural() % 95);
+			fill_string(&str[0], length, printable.data(), printable.size());
 
 			return str;
 		}
@@ -125,9 +366,7 @@ namespace chebyshev {
 
 			std::string str;
 			str.resize(length);
-
-			for (unsigned int i = 0; i < length; ++i)
-				str[i] = alphabet[natural() % alphabet.size()];
+			fill_string(&str[0], length, alphabet.data(), alphabet.size());
 
 			return str;
 		}
@@ -147,9 +386,7 @@ namespace chebyshev {
 
 			std::string str;
 			str.resize(length);
-
-			for (unsigned int i = 0; i < length; ++i)
-				str[i] = alphabet[natural() % alphabet.size()];
+			fill_string(&str[0], length, alphabet.data(), alphabet.size());
 
 			return str;
 		}
@@ -170,12 +407,127 @@ namespace chebyshev {
 			std::vector<T> str;
 			str.resize(length);
 
-			for (unsigned int i = 0; i < length; ++i)
-				str[i] = alphabet[natural() % alphabet.size()];
+			for (size_t i = 0; i < length; ++i)
+				str[i] = alphabet[bounded(alphabet.size())];
 
 			return str;
 		}
 
+
+		/// Generate an array of numbers uniformly
+		/// distributed over [a, b), using the fast engine.
+		///
+		/// @param length The number of elements to generate
+		/// @param a The lower extreme of the interval
+		/// @param b The upper extreme of the interval
+		template<typename Type = double>
+		inline std::vector<Type> array(size_t length, long double a, long double b) {
+
+			std::vector<Type> v (length);
+
+			for (size_t i = 0; i < length; ++i)
+				v[i] = static_cast<Type>(a + (b - a) * real());
+
+			return v;
+		}
+
+
+		/// Generate a sorted array of numbers uniformly
+		/// distributed over [a, b).
+		///
+		/// @param length The number of elements to generate
+		/// @param a The lower extreme of the interval
+		/// @param b The upper extreme of the interval
+		template<typename Type = double>
+		inline std::vector<Type> sorted(size_t length, long double a, long double b) {
+
+			std::vector<Type> v = array<Type>(length, a, b);
+			std::sort(v.begin(), v.end());
+			return v;
+		}
+
+
+		/// Generate a nearly sorted array of numbers uniformly
+		/// distributed over [a, b), by swapping a fraction
+		/// of the elements of a sorted array with another
+		/// element at most a given distance away.
+		///
+		/// @param length The number of elements to generate
+		/// @param a The lower extreme of the interval
+		/// @param b The upper extreme of the interval
+		/// @param disorder The fraction of elements to swap
+		/// @param distance The maximum distance of the swapped elements
+		template<typename Type = double>
+		inline std::vector<Type> nearly_sorted(
+			size_t length, long double a, long double b,
+			long double disorder = 0.05, size_t distance = 8) {
+
+			std::vector<Type> v = sorted<Type>(length, a, b);
+
+			if(length < 2 || !distance)
+				return v;
+
+			const size_t swaps = disorder * length;
+
+			for (size_t k = 0; k < swaps; ++k) {
+
+				const size_t i = bounded(length);
+				const size_t j = std::min(i + 1 + bounded(distance), length - 1);
+				std::swap(v[i], v[j]);
+			}
+
+			return v;
+		}
+
+
+		/// Generate keys in [0, keys) following a Zipf distribution,
+		/// where the probability of the k-th key is proportional to
+		/// 1 / (k + 1)^s, as is common for accesses to real data.
+		///
+		/// @param length The number of keys to generate
+		/// @param keys The number of distinct keys
+		/// @param s The exponent of the distribution
+		inline std::vector<uint64_t> zipf(size_t length, uint64_t keys, long double s = 1.0) {
+
+			if(!keys)
+				throw std::runtime_error("keys in chebyshev::random::zipf must be positive.");
+
+			// Cumulative distribution of the keys
+			std::vector<double> cdf (keys);
+			double total = 0;
+
+			for (uint64_t k = 0; k < keys; ++k) {
+				total += std::pow(k + 1.0, -s);
+				cdf[k] = total;
+			}
+
+			std::vector<uint64_t> v (length);
+
+			for (size_t i = 0; i < length; ++i) {
+
+				const double u = real() * total;
+				const size_t k = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+				v[i] = std::min<uint64_t>(k, keys - 1);
+			}
+
+			return v;
+		}
+
+
+		/// Generate a random matrix with elements uniformly
+		/// distributed over [a, b), stored in row-major order.
+		///
+		/// @param rows The number of rows
+		/// @param cols The number of columns
+		/// @param a The lower extreme of the interval
+		/// @param b The upper extreme of the interval
+		/// @return A vector of rows * cols elements, where the element
+		/// (i, j) has index i * cols + j.
+		template<typename Type = double>
+		inline std::vector<Type> matrix(size_t rows, size_t cols, long double a, long double b) {
+			return array<Type>(rows * cols, a, b);
+		}
+
 	}
 }
 
@@ -0,0 +1,698 @@
+///
+/// @file shard.h Test sharding across worker processes.
+///
+
+#ifndef CHEBYSHEV_SHARD_H
+#define CHEBYSHEV_SHARD_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#include "./output.h"
+#include "./timing.h"
+#include "./metrics.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CHEBYSHEV_SPAWN_POSIX
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+
+namespace chebyshev {
+
+	/// @namespace chebyshev::shard Test sharding across processes
+	///
+	/// Test cases may be deterministically partitioned between multiple
+	/// processes running the same test program, by hashing their names.
+	/// The shard of a process is selected with the "--shard-index=I" and
+	/// "--shard-count=N" command line options, or with the CHEBYSHEV_SHARD_INDEX
+	/// and CHEBYSHEV_SHARD_COUNT environment variables. Passing "--workers=N"
+	/// (or setting CHEBYSHEV_WORKERS) runs the program as a coordinator, which
+	/// launches N worker processes of the same program, one for each shard,
+	/// and merges their results into a single report.
+	namespace shard {
+
+
+		/// @class shard_settings
+		/// Global settings of test sharding.
+		struct shard_settings {
+
+			/// Path of the program, used to launch workers.
+			std::string program = "";
+
+			/// Command line arguments which are forwarded to workers.
+			std::vector<std::string> arguments {};
+
+			/// Index of the shard of the current process.
+			unsigned int shardIndex = 0;
+
+			/// Total number of shards.
+			unsigned int shardCount = 1;
+
+			/// Number of worker processes to launch as a coordinator
+			/// (no workers are launched if zero).
+			unsigned int workers = 0;
+
+			/// Prefix of the result files of a worker process,
+			/// which is set only in worker processes.
+			std::string shardOutput = "";
+
+			/// Name of the only cold-start benchmark to run, which is
+			/// set only in processes launched by cold-start benchmarks.
+			std::string coldStart = "";
+
+			/// Path of the sample file of a cold-start process.
+			std::string coldOutput = "";
+
+		};
+
+
+		/// Global settings of test sharding.
+		CHEBYSHEV_GLOBAL shard_settings settings;
+
+
+		/// Hash a test case name with the 64-bit FNV-1a hash function,
+		/// which gives the same result on all processes and platforms.
+		/// Only the characters before the first " (" are hashed, so that
+		/// variants of the same test case, such as "f (float)" and
+		/// "f (double)", are assigned to the same shard.
+		inline uint64_t hash(const char* name) {
+
+			uint64_t h = 14695981039346656037ULL;
+
+			for (; *name && !(name[0] == ' ' && name[1] == '('); ++name) {
+				h ^= (unsigned char) *name;
+				h *= 1099511628211ULL;
+			}
+
+			return h;
+		}
+
+
+		/// Returns whether the test case with the given name
+		/// belongs to the shard of the current process.
+		inline bool selected(const char* name) {
+
+			// Cold-start processes only run their own
+			// cold-start benchmark, skipping all test cases
+			if(settings.coldStart.size())
+				return false;
+
+			if(settings.shardCount <= 1)
+				return true;
+
+			return (hash(name) % settings.shardCount) == settings.shardIndex;
+		}
+
+
+		/// Returns whether the test case with the given name
+		/// belongs to the shard of the current process.
+		inline bool selected(const std::string& name) {
+			return selected(name.c_str());
+		}
+
+
+		/// Returns the identifier of the current process, used to name
+		/// the files it exchanges with the processes it launches
+		/// (zero on platforms without posix_spawn).
+		inline unsigned long process_id() {
+#ifdef CHEBYSHEV_SPAWN_POSIX
+			return getpid();
+#else
+			return 0;
+#endif
+		}
+
+
+		/// Returns whether the current process is a worker
+		/// launched by a coordinator.
+		inline bool is_worker() {
+			return settings.shardOutput.size() > 0;
+		}
+
+
+		/// Returns whether the current process was launched
+		/// by a cold-start benchmark.
+		inline bool is_cold_start() {
+			return settings.coldStart.size() > 0;
+		}
+
+
+		/// Parse an unsigned integer option, returning
+		/// whether the string starts with the given prefix.
+		inline bool parse_option(
+			const std::string& arg, const std::string& prefix, unsigned int& value) {
+
+			if(arg.compare(0, prefix.size(), prefix) != 0)
+				return false;
+
+			value = std::strtoul(arg.c_str() + prefix.size(), nullptr, 10);
+			return true;
+		}
+
+
+		/// Parse a real option, returning whether
+		/// the string starts with the given prefix.
+		inline bool parse_option(
+			const std::string& arg, const std::string& prefix, long double& value) {
+
+			if(arg.compare(0, prefix.size(), prefix) != 0)
+				return false;
+
+			value = std::strtold(arg.c_str() + prefix.size(), nullptr);
+			return true;
+		}
+
+
+		/// Parse a string option, returning whether
+		/// the string starts with the given prefix.
+		inline bool parse_option(
+			const std::string& arg, const std::string& prefix, std::string& value) {
+
+			if(arg.compare(0, prefix.size(), prefix) != 0)
+				return false;
+
+			value = arg.substr(prefix.size());
+			return true;
+		}
+
+
+		/// Quote an argument for a command line, which is only used to
+		/// launch processes on platforms without posix_spawn.
+		inline std::string quote(const std::string& arg) {
+
+			std::string res = "\"";
+
+			for (char c : arg) {
+				if(c == '"' || c == '\\')
+					res += '\\';
+				res += c;
+			}
+
+			return res + "\"";
+		}
+
+
+		/// Run a program with the given arguments, redirecting its
+		/// standard output and error to a file, and wait for it to exit.
+		/// The arguments are passed to the program as they are, without
+		/// being interpreted by a shell.
+		///
+		/// @param program The path of the program
+		/// @param arguments The command line arguments
+		/// @param log The file to write the output of the program to
+		/// @return The exit status of the program, or -1 if it could
+		/// not be launched or did not exit normally.
+		CHEBYSHEV_INLINE int run_process(
+			const std::string& program,
+			const std::vector<std::string>& arguments,
+			const std::string& log)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+#ifdef CHEBYSHEV_SPAWN_POSIX
+
+			std::vector<char*> argv;
+			argv.push_back(const_cast<char*>(program.c_str()));
+
+			for (const std::string& arg : arguments)
+				argv.push_back(const_cast<char*>(arg.c_str()));
+
+			argv.push_back(nullptr);
+
+			posix_spawn_file_actions_t actions;
+			posix_spawn_file_actions_init(&actions);
+			posix_spawn_file_actions_addopen(&actions, 1, log.c_str(),
+				O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			posix_spawn_file_actions_adddup2(&actions, 1, 2);
+
+			pid_t pid;
+			const int error = posix_spawnp(
+				&pid, program.c_str(), &actions, nullptr, argv.data(), environ);
+
+			posix_spawn_file_actions_destroy(&actions);
+
+			if(error)
+				return -1;
+
+			int status = 0;
+			while(waitpid(pid, &status, 0) < 0)
+				if(errno != EINTR)
+					return -1;
+
+			return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#else
+
+			std::string command = quote(program);
+
+			for (const std::string& arg : arguments)
+				command += " " + quote(arg);
+
+			command += " > " + quote(log) + " 2>&1";
+			return std::system(command.c_str());
+#endif
+		}
+#endif
+
+
+		/// Write a table to a stream as quoted comma separated values,
+		/// doubling quotes inside of values.
+		inline void write_row(std::ostream& out, const std::vector<std::string>& row) {
+
+			for (size_t i = 0; i < row.size(); ++i) {
+
+				out << '"';
+				for (char c : row[i]) {
+					if(c == '"')
+						out << '"';
+					out << c;
+				}
+				out << '"';
+
+				if(i != row.size() - 1)
+					out << ',';
+			}
+
+			out << '\n';
+		}
+
+
+		/// Parse a row of quoted comma separated values.
+		inline std::vector<std::string> read_row(const std::string& line) {
+
+			std::vector<std::string> row;
+			std::string value;
+			bool quoted = false;
+
+			for (size_t i = 0; i < line.size(); ++i) {
+
+				const char c = line[i];
+
+				if(quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+					value += '"';
+					i++;
+				} else if(c == '"') {
+					quoted = !quoted;
+				} else if(c == ',' && !quoted) {
+					row.push_back(value);
+					value.clear();
+				} else {
+					value += c;
+				}
+			}
+
+			row.push_back(value);
+			return row;
+		}
+
+
+		/// Write the results of a module to the result file of the
+		/// worker process, if the current process is a worker.
+		/// Values are written as they are, without interpretation,
+		/// so that they may be merged and formatted by the coordinator.
+		///
+		/// @param results The map of test results of any type
+		/// @param fields The fields of the test results to write
+		template<typename ResultType>
+		inline void write_results(
+			const std::map<std::string, std::vector<ResultType>>& results,
+			const std::vector<std::string>& fields) {
+
+			if(!is_worker() || results.empty())
+				return;
+
+			std::ofstream file (settings.shardOutput + ".csv", std::ios::app);
+			const auto table = output::generate_table(results, fields);
+
+			file << "#table\n";
+			write_row(file, fields);
+
+			for (const auto& row : table)
+				write_row(file, row);
+		}
+
+
+		/// Write the total number of tests and failures of a module
+		/// to the totals file of the worker process, if the current
+		/// process is a worker.
+		inline void write_totals(unsigned int totalTests, unsigned int failedTests) {
+
+			if(!is_worker())
+				return;
+
+			std::ofstream file (settings.shardOutput + ".totals", std::ios::app);
+			file << totalTests << " " << failedTests << "\n";
+		}
+
+
+		/// Write the wall times of test cases to the times file of the
+		/// worker process, if the current process is a worker, so that
+		/// the coordinator may report the slowest test cases of all workers.
+		///
+		/// @param cases The wall times of the test cases
+		inline void write_times(const std::vector<timing::case_time>& cases) {
+
+			if(!is_worker() || cases.empty())
+				return;
+
+			std::ofstream file (settings.shardOutput + ".times", std::ios::app);
+
+			for (const timing::case_time& c : cases) {
+
+				std::stringstream wallTime;
+				wallTime << std::setprecision(std::numeric_limits<long double>::digits10) << c.wallTime;
+				write_row(file, { c.module, c.name, wallTime.str() });
+			}
+		}
+
+
+		/// Run the program as a coordinator, launching one worker process
+		/// for each shard, waiting for them to finish and merging their
+		/// results into a single report, which is printed to standard output
+		/// and written to the given file. The process then exits with the
+		/// total number of failed tests.
+		///
+		/// @param moduleName The name of the module, used to name files
+		CHEBYSHEV_INLINE void coordinate(const std::string& moduleName)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			const unsigned int workers = settings.workers;
+			std::vector<std::string> prefixes (workers);
+			std::vector<std::thread> threads;
+
+			std::cout << "Running " << moduleName << " on "
+				<< workers << " worker processes ..." << std::endl;
+
+			for (unsigned int i = 0; i < workers; ++i) {
+
+				prefixes[i] = moduleName + "_shard" + std::to_string(i);
+
+				std::vector<std::string> arguments = settings.arguments;
+				arguments.push_back("--shard-index=" + std::to_string(i));
+				arguments.push_back("--shard-count=" + std::to_string(workers));
+				arguments.push_back("--shard-output=" + prefixes[i]);
+
+				// Remove stale results of previous executions
+				std::remove((prefixes[i] + ".csv").c_str());
+				std::remove((prefixes[i] + ".totals").c_str());
+				std::remove((prefixes[i] + ".times").c_str());
+
+				const std::string log = prefixes[i] + ".log";
+
+				threads.emplace_back([arguments, log]() {
+					run_process(settings.program, arguments, log);
+				});
+			}
+
+			for (std::thread& t : threads)
+				t.join();
+
+			// Tables with the same fields, in order of appearance
+			std::vector<std::vector<std::string>> tableFields;
+			std::vector<std::vector<std::vector<std::string>>> tables;
+
+			unsigned int totalTests = 0;
+			unsigned int failedTests = 0;
+			std::vector<timing::case_time> cases;
+
+			for (unsigned int i = 0; i < workers; ++i) {
+
+				std::ifstream totals (prefixes[i] + ".totals");
+
+				if(!totals.is_open()) {
+
+					std::cout << "Worker " << i << " did not complete, see "
+						<< prefixes[i] << ".log" << std::endl;
+
+					failedTests++;
+					totalTests++;
+					continue;
+				}
+
+				unsigned int total, failed;
+				while(totals >> total >> failed) {
+					totalTests += total;
+					failedTests += failed;
+				}
+
+				std::ifstream file (prefixes[i] + ".csv");
+				std::string line;
+				size_t current = 0;
+				bool header = false;
+
+				while(std::getline(file, line)) {
+
+					if(line == "#table") {
+
+						std::getline(file, line);
+						const std::vector<std::string> fields = read_row(line);
+
+						auto it = std::find(tableFields.begin(), tableFields.end(), fields);
+						current = it - tableFields.begin();
+
+						if(it == tableFields.end()) {
+							tableFields.push_back(fields);
+							tables.emplace_back();
+						}
+
+						header = true;
+						continue;
+					}
+
+					// Keep only the first header of each table
+					if(!header || !tables[current].size())
+						tables[current].push_back(read_row(line));
+
+					header = false;
+				}
+
+				// Wall times of the test cases of the worker
+				std::ifstream times (prefixes[i] + ".times");
+
+				while(std::getline(times, line)) {
+
+					const std::vector<std::string> row = read_row(line);
+
+					if(row.size() != 3)
+						continue;
+
+					timing::case_time c;
+					c.module = row[0];
+					c.name = row[1];
+					c.wallTime = std::strtold(row[2].c_str(), nullptr);
+					cases.push_back(c);
+				}
+
+				totals.close();
+				file.close();
+				times.close();
+
+				std::remove((prefixes[i] + ".csv").c_str());
+				std::remove((prefixes[i] + ".totals").c_str());
+				std::remove((prefixes[i] + ".times").c_str());
+				std::remove((prefixes[i] + ".log").c_str());
+			}
+
+			const std::string filename = moduleName + "_results";
+			std::ofstream file (filename);
+
+			for (size_t i = 0; i < tables.size(); ++i) {
+
+				auto& table = tables[i];
+				const auto& fields = tableFields[i];
+
+				// Sort rows by name, as in the output of a single process
+				if(fields.size() && fields[0] == "name")
+					std::stable_sort(table.begin() + 1, table.end(),
+						[](const std::vector<std::string>& a, const std::vector<std::string>& b) {
+							return a[0] < b[0];
+						});
+
+				if(!output::settings.quiet)
+					std::cout << "\n" << output::settings.outputFormat(table, fields, output::settings) << "\n";
+
+				file << output::settings.defaultFileOutputFormat(table, fields, output::settings);
+			}
+
+			timing::print_slowest(cases);
+
+			std::cout << "Results have been saved in: " << filename << std::endl;
+			std::cout << "Finished testing " << moduleName << " on "
+				<< workers << " worker processes\n";
+			std::cout << totalTests << " total tests, "
+				<< failedTests << " failed (" << std::setprecision(3)
+				<< (failedTests / (double) totalTests) * 100 << "%)" << std::endl;
+
+			file.close();
+			std::exit(failedTests);
+		}
+#endif
+
+
+		/// Returns whether a command line argument is an option
+		/// of sharding, cold-start benchmarks, timing or live metrics,
+		/// instead of the name of a picked test case.
+		inline bool is_option(const std::string& arg) {
+
+			static const char* prefixes[] = {
+				"--shard-index=", "--shard-count=", "--shard-output=",
+				"--workers=", "--cold-start=", "--cold-output=",
+				"--slowest=", "--time-limit=", "--metrics="
+			};
+
+			for (const char* prefix : prefixes)
+				if(arg.compare(0, std::strlen(prefix), prefix) == 0)
+					return true;
+
+			return false;
+		}
+
+
+		/// Setup sharding from the command line arguments and the
+		/// environment, returning the remaining command line arguments
+		/// (the names of the picked test cases). If the process was
+		/// asked to run as a coordinator, the worker processes are
+		/// launched and the process exits after merging their results.
+		/// The settings of the process, which are shared by all threads,
+		/// are only setup by the first call, so that concurrent contexts
+		/// may be setup safely.
+		///
+		/// @param moduleName The name of the module under test
+		/// @param argc The number of command line arguments
+		/// @param argv A list of C-style strings containing
+		/// the command line arguments.
+		/// @return The list of the picked test case names
+		CHEBYSHEV_INLINE std::vector<std::string> setup(
+			const std::string& moduleName, int argc = 0, const char** argv = nullptr)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			static std::once_flag once;
+
+			std::call_once(once, [&]() {
+
+				const char* env = std::getenv("CHEBYSHEV_SHARD_INDEX");
+				if(env)
+					settings.shardIndex = std::strtoul(env, nullptr, 10);
+
+				env = std::getenv("CHEBYSHEV_SHARD_COUNT");
+				if(env)
+					settings.shardCount = std::strtoul(env, nullptr, 10);
+
+				env = std::getenv("CHEBYSHEV_WORKERS");
+				if(env)
+					settings.workers = std::strtoul(env, nullptr, 10);
+
+				env = std::getenv("CHEBYSHEV_SLOWEST");
+				if(env)
+					timing::settings.slowest = std::strtoul(env, nullptr, 10);
+
+				env = std::getenv("CHEBYSHEV_TIME_LIMIT");
+				if(env)
+					timing::settings.timeLimit = std::strtold(env, nullptr);
+
+				env = std::getenv("CHEBYSHEV_METRICS");
+				if(env)
+					metrics::settings.name = env;
+
+				if(argc && argv) {
+
+					settings.program = argv[0];
+
+					for (int i = 1; i < argc; ++i) {
+
+						const std::string arg = argv[i];
+
+						if(parse_option(arg, "--shard-index=", settings.shardIndex) ||
+							parse_option(arg, "--shard-count=", settings.shardCount) ||
+							parse_option(arg, "--shard-output=", settings.shardOutput))
+							continue;
+
+						if(parse_option(arg, "--workers=", settings.workers))
+							continue;
+
+						if(parse_option(arg, "--cold-start=", settings.coldStart) ||
+							parse_option(arg, "--cold-output=", settings.coldOutput))
+							continue;
+
+						// Other arguments, including timing and
+						// metrics options, are forwarded to workers
+						parse_option(arg, "--slowest=", timing::settings.slowest);
+						parse_option(arg, "--time-limit=", timing::settings.timeLimit);
+						parse_option(arg, "--metrics=", metrics::settings.name);
+
+						settings.arguments.push_back(arg);
+					}
+				}
+
+				if(settings.shardCount == 0)
+					settings.shardCount = 1;
+
+				if(settings.shardIndex >= settings.shardCount)
+					throw std::runtime_error("Shard index out of range in shard::setup");
+
+				// Workers and cold-start processes never launch workers
+				if(settings.workers && !is_worker() && !is_cold_start()) {
+
+					if(!settings.program.size())
+						throw std::runtime_error(
+							"Command line arguments are needed to launch workers in shard::setup");
+
+					output::setup();
+					coordinate(moduleName);
+				}
+
+				// Publish live metrics, in a separate segment for each worker
+				if(metrics::settings.name.size() && !is_cold_start()) {
+
+					const std::string segment = metrics::settings.name +
+						(is_worker() ? ("." + std::to_string(settings.shardIndex)) : "");
+
+					if(!metrics::open(segment))
+						std::cout << "Unable to open the live metrics segment "
+							<< metrics::segment_name(segment) << std::endl;
+				}
+			});
+
+			std::vector<std::string> picked;
+
+			if(argc && argv)
+				for (int i = 1; i < argc; ++i)
+					if(!is_option(argv[i]))
+						picked.push_back(argv[i]);
+
+			if(metrics::settings.name.size() && !is_cold_start())
+				metrics::begin(moduleName);
+
+			return picked;
+		}
+#endif
+
+	}
+}
+
+#endif
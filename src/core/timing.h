@@ -0,0 +1,167 @@
+///
+/// @file timing.h Wall time accounting of test cases.
+///
+
+#ifndef CHEBYSHEV_TIMING_H
+#define CHEBYSHEV_TIMING_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "./common.h"
+#include "./output.h"
+#include "../benchmark/timer.h"
+
+
+namespace chebyshev {
+
+	/// @namespace chebyshev::timing Wall time accounting of test cases
+	///
+	/// The wall time spent on each test case, from the start of
+	/// its registration to the storage of its result, is stored in
+	/// the "wallTime" field of its result (in milliseconds) and recorded
+	/// by module, so that the slowest test cases may be reported with
+	/// their share of the total time when the module is terminated.
+	/// An optional time limit on each test case, set with the
+	/// "--time-limit=MS" command line option or the CHEBYSHEV_TIME_LIMIT
+	/// environment variable, fails the test cases which exceed it.
+	/// The number of reported test cases is set with "--slowest=N"
+	/// or the CHEBYSHEV_SLOWEST environment variable.
+	namespace timing {
+
+
+		/// @class timing_settings
+		/// Global settings of wall time accounting.
+		struct timing_settings {
+
+			/// Number of the slowest test cases to report
+			/// when terminating a module (none if zero).
+			unsigned int slowest = CHEBYSHEV_SLOWEST;
+
+			/// Time limit on each test case in milliseconds,
+			/// after which the test case fails (no limit if zero).
+			long double timeLimit = CHEBYSHEV_TIME_LIMIT;
+
+		};
+
+
+		/// Global settings of wall time accounting.
+		CHEBYSHEV_GLOBAL timing_settings settings;
+
+
+		/// @class case_time
+		/// The wall time of a test case.
+		struct case_time {
+
+			/// The module of the test case
+			/// (e.g. "prec", "benchmark" or "err").
+			std::string module = "";
+
+			/// The name of the test case.
+			std::string name = "";
+
+			/// Wall time of the test case in milliseconds.
+			long double wallTime = 0;
+		};
+
+
+		/// Wall times of the test cases which have not
+		/// been reported yet, in order of registration,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local std::vector<case_time> records;
+
+
+		/// Record the wall time of a test case,
+		/// returning whether it exceeded the time limit.
+		///
+		/// @param module The module of the test case
+		/// @param name The name of the test case
+		/// @param wallTime The wall time of the test case in milliseconds
+		inline bool record(const std::string& module, const std::string& name, long double wallTime) {
+
+			case_time c;
+			c.module = module;
+			c.name = name;
+			c.wallTime = wallTime;
+			records.push_back(c);
+
+			return (settings.timeLimit > 0) && (wallTime > settings.timeLimit);
+		}
+
+
+		/// Remove and return the recorded wall times of a module.
+		///
+		/// @param module The module of the test cases
+		inline std::vector<case_time> take(const std::string& module) {
+
+			std::vector<case_time> res;
+			std::vector<case_time> others;
+
+			for (const case_time& c : records)
+				(c.module == module ? res : others).push_back(c);
+
+			records = others;
+			return res;
+		}
+
+
+		/// Print the slowest test cases to standard output, with their
+		/// share of the total wall time of all the given test cases.
+		///
+		/// @param cases The wall times of the test cases
+		CHEBYSHEV_INLINE void print_slowest(std::vector<case_time> cases)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			if(!cases.size() || !settings.slowest || output::settings.quiet)
+				return;
+
+			long double total = 0;
+			for (const case_time& c : cases)
+				total += c.wallTime;
+
+			std::stable_sort(cases.begin(), cases.end(),
+				[](const case_time& a, const case_time& b) {
+					return a.wallTime > b.wallTime;
+				});
+
+			const size_t count = std::min<size_t>(settings.slowest, cases.size());
+			const std::vector<std::string> fields = { "name", "wallTime", "share" };
+
+			std::vector<std::vector<std::string>> table = {
+				{ output::settings.fieldNames["name"],
+				  output::settings.fieldNames["wallTime"],
+				  output::settings.fieldNames["share"] }
+			};
+
+			for (size_t i = 0; i < count; ++i) {
+
+				std::stringstream wallTime;
+				wallTime << std::setprecision(4) << cases[i].wallTime;
+
+				std::stringstream share;
+				share << std::fixed << std::setprecision(1)
+					<< (total > 0 ? (cases[i].wallTime / total * 100) : 0) << "%";
+
+				table.push_back({ cases[i].name, wallTime.str(), share.str() });
+			}
+
+			std::stringstream totalTime;
+			totalTime << std::setprecision(4) << total;
+
+			std::cout << "\nSlowest " << count << " of " << cases.size()
+				<< " test cases (" << totalTime.str() << " ms in total):\n"
+				<< output::settings.outputFormat(table, fields, output::settings) << "\n";
+		}
+#endif
+
+	}
+}
+
+#endif
@@ -9,9 +9,15 @@
 #include <vector>
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <tuple>
+#include <utility>
 
 #include "./core/common.h"
 #include "./core/random.h"
+#include "./core/output.h"
+#include "./core/shard.h"
+#include "./core/timing.h"
 #include "./err/err_structures.h"
 
 
@@ -79,7 +85,17 @@ namespace chebyshev {
 			/// Whether to print to standard output
 			bool quiet = false;
 
-		} settings;
+			/// Whether to store the results of passing checks made
+			/// with err::check (by default, only failures are stored
+			/// and passing checks only update the counters).
+			bool verbose = false;
+
+		};
+
+
+		/// Settings of the error checking module,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local err_settings settings;
 
 
 		/// @class err_results Results of error checking
@@ -100,7 +116,12 @@ namespace chebyshev {
 			/// Results of exception testing
 			std::map<std::string, std::vector<exception_result>> exceptionResults {};
 
-		} results;
+		};
+
+
+		/// Results of the error checking module,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local err_results results;
 
 
 		/// Setup error checking module.
@@ -109,12 +130,17 @@ namespace chebyshev {
 		/// @param argc The number of command line arguments
 		/// @param argv A list of C-style strings containing
 		/// the command line arguments.
-		inline void setup(
-			const std::string& moduleName, int argc = 0, const char** argv = nullptr) {
-
-			if(argc && argv)
-				for (int i = 1; i < argc; ++i)
-					settings.pickedChecks[argv[i]] = true;
+		CHEBYSHEV_INLINE void setup(
+			const std::string& moduleName, int argc = 0, const char** argv = nullptr)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			// Initialize list of picked checks and sharding,
+			// running as a coordinator of worker processes if requested.
+			for (const std::string& name : shard::setup(moduleName, argc, argv))
+				settings.pickedChecks[name] = true;
 
 			std::cout << "Starting error checking on "
 				<< moduleName << " ..." << std::endl;
@@ -126,16 +152,39 @@ namespace chebyshev {
 			random::setup();
 			output::setup();
 		}
+#endif
 
 
 		/// Terminate the error testing environment.
 		/// If test cases have been run, their results will be printed.
 		///
 		/// @param exit Whether to exit after terminating the module.
-		inline void terminate(bool exit = true) {
+		CHEBYSHEV_INLINE void terminate(bool exit = true)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			output::settings.quiet = settings.quiet;
 
+			// Worker processes hand their results to the coordinator,
+			// which writes the merged results to the output files.
+			if(shard::is_worker()) {
+
+				shard::write_results(results.assertResults, settings.assertColumns);
+				shard::write_results(results.errnoResults, settings.errnoColumns);
+				shard::write_results(results.exceptionResults, settings.exceptionColumns);
+				shard::write_totals(results.totalChecks, results.failedChecks);
+				shard::write_times(timing::take("err"));
+
+				settings.outputToFile = false;
+				settings.outputFiles.clear();
+				settings.assertOutputFiles.clear();
+				settings.errnoOutputFiles.clear();
+				settings.exceptionOutputFiles.clear();
+				output::settings.outputFiles.clear();
+			}
+
 			// Output to file is true but no specific files are specified, add default output file.
 			if(	 settings.outputToFile &&
 				!output::settings.outputFiles.size() &&
@@ -170,21 +219,34 @@ namespace chebyshev {
 
 			output::print_results(results.exceptionResults, settings.exceptionColumns, outputFiles);
 
-			std::cout << "Finished error checking " << settings.moduleName << " ...\n";
-			std::cout << results.totalChecks
+			// Report the slowest checks
+			timing::print_slowest(timing::take("err"));
+
+			// Publish the termination of the module
+			metrics::end();
+
+			// Format the summary locally, as the formatting state
+			// of std::cout is shared by concurrent contexts
+			std::stringstream summary;
+			summary << "Finished error checking " << settings.moduleName << " ...\n";
+			summary << results.totalChecks
 				<< " total checks, "
 				<< results.failedChecks << " failed ("  << std::setprecision(3)
 				<< (results.failedChecks / (double) results.totalChecks * 100.0)
-				<< "%)" << std::endl;
+				<< "%)";
+			std::cout << summary.str() << std::endl;
+
+			const unsigned int failedChecks = results.failedChecks;
 
 			// Discard previous results
 			results = err_results();
 
 			if(exit) {
 				output::terminate();
-				std::exit(results.failedChecks);
+				std::exit(failedChecks);
 			}
 		}
+#endif
 
 
 		/// Assert that an expression is true.
@@ -192,11 +254,23 @@ namespace chebyshev {
 		/// @param name Name of the check (function name or test case name).
 		/// @param exp Expression to test for truth.
 		/// @param description Description of the assertion.
-		inline void assert(
+		CHEBYSHEV_INLINE void assert(
 			const std::string& name,
 			bool exp,
 			std::string description = "",
-			bool quiet = false) {
+			bool quiet = false)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			// Skip the check if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
 
 			assert_result res {};
 
@@ -206,13 +280,158 @@ namespace chebyshev {
 			res.description = description;
 			res.quiet = quiet;
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("err", name, res.wallTime) || res.failed;
+
 			results.totalChecks++;
 
-			if(!exp)
+			if(res.failed)
 				results.failedChecks++;
 
+			metrics::test_case("err", res.name, res.failed);
+
 			results.assertResults[name].push_back(res);
 		}
+#endif
+
+
+		/// @class lazy_description
+		/// A description of a check which is formatted only when needed,
+		/// holding a copy of its arguments. The arguments are written
+		/// in order to a string stream when the description is called.
+		/// @see err::describe
+		template<typename ...Args>
+		struct lazy_description {
+
+			/// The arguments of the description.
+			std::tuple<Args...> args;
+
+
+			/// Construct the description from its arguments.
+			lazy_description(const Args& ...args) : args(args...) {}
+
+
+			/// Format the description to a string.
+			inline std::string operator()() const {
+
+				std::stringstream s;
+				write(s, std::index_sequence_for<Args...>());
+				return s.str();
+			}
+
+		private:
+
+			template<size_t ...Indices>
+			inline void write(std::stringstream& s, std::index_sequence<Indices...>) const {
+
+				int order[] = { 0, ((void) (s << std::get<Indices>(args)), 0)... };
+				(void) order;
+			}
+		};
+
+
+		/// Capture the arguments of a description without formatting it,
+		/// so that the string is only built if a check fails.
+		/// Arguments are copied, so string literals and numbers can be
+		/// captured without memory allocation.
+		///
+		/// @param args The arguments to write to the description, in order
+		/// @return A lazy description, to be passed to err::check
+		template<typename ...Args>
+		inline lazy_description<typename std::decay<const Args>::type...> describe(const Args& ...args) {
+			return lazy_description<typename std::decay<const Args>::type...>(args...);
+		}
+
+
+		/// Resolve a constant description to a string.
+		inline std::string resolve_description(const char* description) {
+			return description;
+		}
+
+
+		/// Resolve a constant description to a string.
+		inline std::string resolve_description(const std::string& description) {
+			return description;
+		}
+
+
+		/// Resolve a lazy description, or any function returning
+		/// a string, by calling it.
+		template<typename Description>
+		inline auto resolve_description(const Description& description)
+			-> decltype(std::string(description())) {
+			return description();
+		}
+
+
+		/// Check that an expression is true, with minimal overhead on passing
+		/// checks. The description may be a string, a function returning a
+		/// string or a lazy description constructed with err::describe, and
+		/// is only resolved if the check fails. Passing checks only update
+		/// the counters of the module, unless settings.verbose is true,
+		/// while an assertion result is stored for failing checks.
+		///
+		/// @param name Name of the check (function name or test case name).
+		/// @param exp Expression to test for truth.
+		/// @param description Description of the check.
+		/// @param quiet Whether to print the result.
+		template<typename Description = const char*>
+		inline void check(
+			const char* name,
+			bool exp,
+			const Description& description = "",
+			bool quiet = false) {
+
+			// Skip the check if any checks have been picked
+			// and this one was not picked.
+			if(settings.pickedChecks.size())
+				if(settings.pickedChecks.find(name) == settings.pickedChecks.end())
+					return;
+
+			// Skip the check if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			results.totalChecks++;
+
+			if(exp && !settings.verbose) {
+				metrics::test_case("err", name, false);
+				return;
+			}
+
+			assert_result res {};
+
+			res.name = name;
+			res.evaluated = exp;
+			res.failed = !exp;
+			res.description = resolve_description(description);
+			res.quiet = quiet;
+
+			if(!exp)
+				results.failedChecks++;
+
+			metrics::test_case("err", res.name, res.failed);
+
+			results.assertResults[res.name].push_back(res);
+		}
+
+
+		/// Check that an expression is true, with minimal overhead on passing
+		/// checks, resolving the description only if the check fails.
+		///
+		/// @param name Name of the check (function name or test case name).
+		/// @param exp Expression to test for truth.
+		/// @param description Description of the check.
+		/// @param quiet Whether to print the result.
+		template<typename Description = const char*>
+		inline void check(
+			const std::string& name,
+			bool exp,
+			const Description& description = "",
+			bool quiet = false) {
+
+			check(name.c_str(), exp, description, quiet);
+		}
 
 
 		/// Check errno value after function call
@@ -229,6 +448,14 @@ namespace chebyshev {
 			int expected_errno,
 			bool quiet = false) {
 
+			// Skip the check if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
 			errno_result res {};
 			errno = 0;
 
@@ -243,11 +470,16 @@ namespace chebyshev {
 			res.failed = (errno != expected_errno);
 			res.quiet = quiet;
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("err", name, res.wallTime) || res.failed;
+
 			results.totalChecks++;
 
 			if(res.failed)
 				results.failedChecks++;
 
+			metrics::test_case("err", res.name, res.failed);
+
 			results.errnoResults[name].push_back(res);
 		}
 
@@ -285,6 +517,14 @@ namespace chebyshev {
 			bool quiet = false) {
 
 
+			// Skip the check if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
 			errno_result res {};
 			errno = 0;
 
@@ -303,11 +543,16 @@ namespace chebyshev {
 				if(!(errno & flag))
 					res.failed = true;
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("err", name, res.wallTime) || res.failed;
+
 			results.totalChecks++;
 
 			if(res.failed)
 				results.failedChecks++;
 
+			metrics::test_case("err", res.name, res.failed);
+
 			results.errnoResults[name].push_back(res);
 		}
 
@@ -342,6 +587,14 @@ namespace chebyshev {
 			InputType x,
 			bool quiet = false) {
 
+			// Skip the check if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
 			exception_result res {};
 			bool thrown = false;
 
@@ -358,10 +611,15 @@ namespace chebyshev {
 			res.correctType = true;
 			res.quiet = quiet;
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("err", name, res.wallTime) || res.failed;
+
 			results.totalChecks++;
-			if(!thrown)
+			if(res.failed)
 				results.failedChecks++;
 
+			metrics::test_case("err", res.name, res.failed);
+
 			results.exceptionResults[name].push_back(res);
 		}
 
@@ -395,6 +653,14 @@ namespace chebyshev {
 			InputType x,
 			bool quiet = false) {
 
+			// Skip the check if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
 			exception_result res {};
 			bool thrown = false;
 			bool correctType = false;
@@ -417,10 +683,15 @@ namespace chebyshev {
 			res.correctType = correctType;
 			res.quiet = quiet;
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("err", name, res.wallTime) || res.failed;
+
 			results.totalChecks++;
-			if(!thrown)
+			if(res.failed)
 				results.failedChecks++;
 
+			metrics::test_case("err", res.name, res.failed);
+
 			results.exceptionResults[name].push_back(res);
 		}
 
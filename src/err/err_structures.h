@@ -29,6 +29,9 @@ namespace chebyshev {
 			/// Description of the assertion
 			std::string description = "";
 
+			/// Wall time spent on the test case, in milliseconds.
+			long double wallTime = 0;
+
 			/// Whether the test failed
 			bool failed = true;
 
@@ -50,6 +53,9 @@ namespace chebyshev {
 			/// Expected errno flags
 			std::vector<int> expectedFlags;
 
+			/// Wall time spent on the test case, in milliseconds.
+			long double wallTime = 0;
+
 			/// Whether the test failed.
 			bool failed = true;
 
@@ -72,6 +78,9 @@ namespace chebyshev {
 			/// was correct.
 			bool correctType = true;
 
+			/// Wall time spent on the test case, in milliseconds.
+			long double wallTime = 0;
+
 			/// Whether the test failed.
 			bool failed = true;
 
@@ -0,0 +1,386 @@
+///
+/// @file error_paths.h Benchmarks of the cost of error reporting.
+///
+
+#ifndef CHEBYSHEV_ERROR_PATHS_H
+#define CHEBYSHEV_ERROR_PATHS_H
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cerrno>
+#include <cfenv>
+
+#include "../err.h"
+#include "../benchmark.h"
+
+
+namespace chebyshev {
+
+	namespace err {
+
+
+		/// Generate the input vectors of the happy and error paths.
+		template<typename InputType>
+		inline void generate_paths(
+			std::vector<InputType>& happyInput,
+			std::vector<InputType>& errorInput,
+			benchmark::InputGenerator<InputType> happyGenerator,
+			benchmark::InputGenerator<InputType> errorGenerator,
+			unsigned int iterations) {
+
+			happyInput.resize(iterations);
+			errorInput.resize(iterations);
+
+			for (unsigned int i = 0; i < iterations; ++i) {
+				happyInput[i] = happyGenerator(i);
+				errorInput[i] = errorGenerator(i);
+			}
+		}
+
+
+		/// @class path_call
+		/// Call of a function on an error path, which returns
+		/// the result of the function, or zero for void functions,
+		/// so that the call may be benchmarked.
+		template<typename ReturnType>
+		struct path_call {
+
+			template<typename Function, typename InputType>
+			static ReturnType call(Function& f, const InputType& x) {
+				return f(x);
+			}
+		};
+
+
+		/// Call of a void function on an error path.
+		template<>
+		struct path_call<void> {
+
+			template<typename Function, typename InputType>
+			static int call(Function& f, const InputType& x) {
+				f(x);
+				return 0;
+			}
+		};
+
+
+		/// Returns whether the happy path or the error path
+		/// of a test case should run, according to the picked
+		/// benchmarks and the current shard.
+		inline bool paths_selected(const std::string& name) {
+			return benchmark::should_run(name + " (happy path)") ||
+				benchmark::should_run(name + " (error path)");
+		}
+
+
+		/// Benchmark the happy path and the error path of a function
+		/// with the given wrapper, registering both results in the
+		/// benchmark module and storing in the error path result the
+		/// "slowdown" (ratio of the average runtimes) and the "errorRate"
+		/// (fraction of error path calls which reported an error).
+		template<typename InputType, typename Wrapper>
+		inline void benchmark_paths(
+			const std::string& name,
+			Wrapper wrapper,
+			unsigned long& reported,
+			unsigned long& calls,
+			const std::vector<InputType>& happyInput,
+			const std::vector<InputType>& errorInput,
+			unsigned int runs,
+			bool quiet) {
+
+			const std::string happyName = name + " (happy path)";
+			const std::string errorName = name + " (error path)";
+
+			benchmark::benchmark(happyName, wrapper, happyInput, runs, quiet);
+
+			reported = 0;
+			calls = 0;
+			benchmark::benchmark(errorName, wrapper, errorInput, runs, quiet);
+
+			auto& benchmarkResults = benchmark::results.benchmarkResults;
+
+			// Skip paths which were not picked or belong to another shard
+			if(benchmarkResults.find(happyName) == benchmarkResults.end() ||
+				benchmarkResults.find(errorName) == benchmarkResults.end())
+				return;
+
+			auto& happy = benchmarkResults[happyName].back();
+			auto& error = benchmarkResults[errorName].back();
+
+			error.additionalFields["slowdown"] = error.averageRuntime / happy.averageRuntime;
+			error.additionalFields["errorRate"] = calls ? (reported / (long double) calls) : 0;
+		}
+
+
+		/// Benchmark the cost of throwing an exception from a function,
+		/// comparing the average runtime over inputs which do not cause
+		/// an error (happy path) with inputs which cause the function
+		/// to throw (error path). Both paths are registered as results
+		/// of the benchmark module, which must be setup.
+		///
+		/// @param name The name of the test case
+		/// @param f The function to benchmark
+		/// @param happyGenerator The generator of inputs which do not cause errors
+		/// @param errorGenerator The generator of inputs which cause errors
+		/// @param runs The number of runs with the same input
+		/// @param iterations The number of inputs of each path
+		/// @param quiet Whether to output the results
+		template<typename InputType = double, typename Function>
+		inline void benchmark_exception(
+			const std::string& name,
+			Function f,
+			benchmark::InputGenerator<InputType> happyGenerator,
+			benchmark::InputGenerator<InputType> errorGenerator,
+			unsigned int runs = benchmark::settings.defaultRuns,
+			unsigned int iterations = benchmark::settings.defaultIterations,
+			bool quiet = false) {
+
+			// Skip the test case before generating its input,
+			// if neither path was picked or belongs to this shard
+			if(!paths_selected(name))
+				return;
+
+			std::vector<InputType> happyInput, errorInput;
+			generate_paths(happyInput, errorInput, happyGenerator, errorGenerator, iterations);
+
+			using ReturnType = decltype(f(happyInput[0]));
+			using ResultType = decltype(path_call<ReturnType>::call(f, happyInput[0]));
+			unsigned long reported = 0;
+			unsigned long calls = 0;
+
+			auto wrapper = [&](InputType x) -> ResultType {
+
+				calls++;
+
+				try {
+					return path_call<ReturnType>::call(f, x);
+				} catch(...) {
+					reported++;
+					return ResultType();
+				}
+			};
+
+			benchmark_paths(name, wrapper, reported, calls, happyInput, errorInput, runs, quiet);
+		}
+
+
+		/// Benchmark the cost of setting errno in a function,
+		/// comparing the average runtime over inputs which do not
+		/// cause an error (happy path) with inputs which cause the
+		/// function to set errno (error path). errno is reset before
+		/// and read after each call on both paths.
+		///
+		/// @param name The name of the test case
+		/// @param f The function to benchmark
+		/// @param happyGenerator The generator of inputs which do not cause errors
+		/// @param errorGenerator The generator of inputs which cause errors
+		/// @param runs The number of runs with the same input
+		/// @param iterations The number of inputs of each path
+		/// @param quiet Whether to output the results
+		template<typename InputType = double, typename Function>
+		inline void benchmark_errno(
+			const std::string& name,
+			Function f,
+			benchmark::InputGenerator<InputType> happyGenerator,
+			benchmark::InputGenerator<InputType> errorGenerator,
+			unsigned int runs = benchmark::settings.defaultRuns,
+			unsigned int iterations = benchmark::settings.defaultIterations,
+			bool quiet = false) {
+
+			// Skip the test case before generating its input,
+			// if neither path was picked or belongs to this shard
+			if(!paths_selected(name))
+				return;
+
+			std::vector<InputType> happyInput, errorInput;
+			generate_paths(happyInput, errorInput, happyGenerator, errorGenerator, iterations);
+
+			using ReturnType = decltype(f(happyInput[0]));
+			using ResultType = decltype(path_call<ReturnType>::call(f, happyInput[0]));
+			unsigned long reported = 0;
+			unsigned long calls = 0;
+
+			auto wrapper = [&](InputType x) -> ResultType {
+
+				calls++;
+				errno = 0;
+				ResultType r = path_call<ReturnType>::call(f, x);
+
+				if(errno)
+					reported++;
+
+				return r;
+			};
+
+			benchmark_paths(name, wrapper, reported, calls, happyInput, errorInput, runs, quiet);
+		}
+
+
+		/// Benchmark the cost of raising a floating point exception
+		/// in a function, comparing the average runtime over inputs which
+		/// do not cause an error (happy path) with inputs which raise any
+		/// of the given floating point exceptions (error path).
+		/// The exception flags are cleared before and tested after each call.
+		///
+		/// @param name The name of the test case
+		/// @param f The function to benchmark
+		/// @param happyGenerator The generator of inputs which do not cause errors
+		/// @param errorGenerator The generator of inputs which cause errors
+		/// @param exceptions The floating point exceptions to test for
+		/// (defaults to FE_INVALID)
+		/// @param runs The number of runs with the same input
+		/// @param iterations The number of inputs of each path
+		/// @param quiet Whether to output the results
+		template<typename InputType = double, typename Function>
+		inline void benchmark_fenv(
+			const std::string& name,
+			Function f,
+			benchmark::InputGenerator<InputType> happyGenerator,
+			benchmark::InputGenerator<InputType> errorGenerator,
+			int exceptions = FE_INVALID,
+			unsigned int runs = benchmark::settings.defaultRuns,
+			unsigned int iterations = benchmark::settings.defaultIterations,
+			bool quiet = false) {
+
+			// Skip the test case before generating its input,
+			// if neither path was picked or belongs to this shard
+			if(!paths_selected(name))
+				return;
+
+			std::vector<InputType> happyInput, errorInput;
+			generate_paths(happyInput, errorInput, happyGenerator, errorGenerator, iterations);
+
+			using ReturnType = decltype(f(happyInput[0]));
+			using ResultType = decltype(path_call<ReturnType>::call(f, happyInput[0]));
+			unsigned long reported = 0;
+			unsigned long calls = 0;
+
+			auto wrapper = [&](InputType x) -> ResultType {
+
+				calls++;
+				std::feclearexcept(FE_ALL_EXCEPT);
+				ResultType r = path_call<ReturnType>::call(f, x);
+
+				if(std::fetestexcept(exceptions))
+					reported++;
+
+				return r;
+			};
+
+			benchmark_paths(name, wrapper, reported, calls, happyInput, errorInput, runs, quiet);
+		}
+
+
+		/// Recursive function which descends the given number of
+		/// stack frames and then throws std::domain_error or returns.
+		/// It is called through a volatile pointer so that the
+		/// recursion is not inlined or turned into a loop.
+		inline int unwind_frame(unsigned int depth, bool shouldThrow);
+
+		/// Volatile pointer to the recursive frame function.
+		static int (* volatile unwind_frame_ptr)(unsigned int, bool) = unwind_frame;
+
+		inline int unwind_frame(unsigned int depth, bool shouldThrow) {
+
+			if(depth == 0) {
+
+				if(shouldThrow)
+					throw std::domain_error("chebyshev::err::unwind_frame");
+
+				return 1;
+			}
+
+			return 1 + unwind_frame_ptr(depth - 1, shouldThrow);
+		}
+
+
+		/// Benchmark the cost of unwinding the stack when throwing
+		/// std::domain_error through a given number of stack frames.
+		/// For each depth, the average runtime of throwing and catching
+		/// the exception is registered as a result of the benchmark module,
+		/// with the "depth", the "baseline" runtime of returning normally
+		/// through the same frames and the "unwindCost" (difference between
+		/// the two) as additional fields.
+		///
+		/// @param name The name of the test case
+		/// @param depths The stack depths to measure
+		/// @param runs The number of runs
+		/// @param iterations The number of exceptions thrown in each run
+		/// @param quiet Whether to output the results
+		inline void benchmark_unwinding(
+			const std::string& name,
+			const std::vector<unsigned int>& depths = { 1, 4, 16, 64 },
+			unsigned int runs = benchmark::settings.defaultRuns,
+			unsigned int iterations = benchmark::settings.defaultIterations,
+			bool quiet = false) {
+
+			for (unsigned int depth : depths) {
+
+				const std::string caseName = name + " (depth " + std::to_string(depth) + ")";
+
+				// Skip the depth before measuring anything, if it was
+				// not picked or it belongs to another shard
+				if(!benchmark::should_run(caseName))
+					continue;
+
+				std::vector<unsigned int> input (iterations, depth);
+
+				auto throwing = [](unsigned int d) -> int {
+					try {
+						return unwind_frame_ptr(d, true);
+					} catch(std::domain_error&) {
+						return 0;
+					}
+				};
+
+				auto returning = [](unsigned int d) -> int {
+					try {
+						return unwind_frame_ptr(d, false);
+					} catch(std::domain_error&) {
+						return 0;
+					}
+				};
+
+				benchmark::benchmark(caseName, throwing, input, runs, quiet);
+
+				if(benchmark::results.benchmarkResults.find(caseName) ==
+					benchmark::results.benchmarkResults.end())
+					continue;
+
+				auto& res = benchmark::results.benchmarkResults[caseName].back();
+
+				// Measure the baseline without registering it, only if the
+				// case was run, reusing the cached baseline of cached cases
+				std::string baselineKey;
+				benchmark::benchmark_result base {};
+
+				if(cache::settings.enabled)
+					baselineKey = cache::key(caseName + " (baseline)",
+						"runs=" + std::to_string(runs) +
+						";iterations=" + std::to_string(iterations));
+
+				if(!res.cached || !cache::lookup(baselineKey, base)) {
+
+					long double total = 0;
+					for (unsigned int i = 0; i < runs; ++i)
+						total += benchmark::runtime(returning, input);
+
+					base.runs = runs;
+					base.iterations = iterations;
+					base.averageRuntime = total / ((long double) runs * iterations);
+					cache::store(baselineKey, base);
+				}
+
+				const long double baseline = base.averageRuntime;
+				res.additionalFields["depth"] = depth;
+				res.additionalFields["baseline"] = baseline;
+				res.additionalFields["unwindCost"] = res.averageRuntime - baseline;
+			}
+		}
+
+	}
+}
+
+#endif
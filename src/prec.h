@@ -9,15 +9,27 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <array>
+#include <type_traits>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <ctime>
 
 #include "./prec/prec_structures.h"
 #include "./prec/fail.h"
 #include "./prec/estimator.h"
+#include "./prec/sweep.h"
+#include "./prec/bound.h"
+#include "./prec/residual.h"
+#include "./prec/multi_double.h"
+#include "./prec/static_estimate.h"
 #include "./core/output.h"
 #include "./core/random.h"
+#include "./core/shard.h"
+#include "./core/timing.h"
+#include "./core/cache.h"
 
 
 namespace chebyshev {
@@ -78,7 +90,12 @@ namespace chebyshev {
 			/// by command line. (all tests will be executed if empty)
 			std::map<std::string, bool> pickedTests {};
 
-		} settings;
+		};
+
+
+		/// Settings of the precision testing module,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local prec_settings settings;
 
 
 		/// @class prec_results Test results of the precision testing module.
@@ -96,7 +113,12 @@ namespace chebyshev {
 			/// Results of equation evaluation
 			std::map<std::string, std::vector<equation_result>> equationResults {};
 			
-		} results;
+		};
+
+
+		/// Results of the precision testing module,
+		/// local to each thread (see chebyshev::context).
+		CHEBYSHEV_GLOBAL thread_local prec_results results;
 
 
 		/// Setup the precision testing environment.
@@ -105,16 +127,20 @@ namespace chebyshev {
 		/// @param argc The number of command line arguments
 		/// @param argv A list of C-style strings containing
 		/// the command line arguments.
-		inline void setup(
+		CHEBYSHEV_INLINE void setup(
 			std::string moduleName,
 			int argc = 0,
-			const char** argv = nullptr) {
+			const char** argv = nullptr)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 
-			// Initialize list of picked tests
-			if(argc && argv)
-				for (int i = 1; i < argc; ++i)
-					settings.pickedTests[argv[i]] = true;
+			// Initialize list of picked tests and sharding,
+			// running as a coordinator of worker processes if requested.
+			for (const std::string& name : shard::setup(moduleName, argc, argv))
+				settings.pickedTests[name] = true;
 
 			std::cout << "Starting precision testing of the "
 				<< moduleName << " module ..." << std::endl;
@@ -126,16 +152,37 @@ namespace chebyshev {
 			random::setup();
 			output::setup();
 		}
+#endif
 
 
 		/// Terminate the precision testing environment,
 		/// printing the results to standard output and output files.
 		///
 		/// @param exit Whether to exit after terminating the module.
-		inline void terminate(bool exit = true) {
+		CHEBYSHEV_INLINE void terminate(bool exit = true)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			output::settings.quiet = settings.quiet;
 
+			// Worker processes hand their results to the coordinator,
+			// which writes the merged results to the output files.
+			if(shard::is_worker()) {
+
+				shard::write_results(results.estimateResults, settings.estimateColumns);
+				shard::write_results(results.equationResults, settings.equationColumns);
+				shard::write_totals(results.totalTests, results.failedTests);
+				shard::write_times(timing::take("prec"));
+
+				settings.outputToFile = false;
+				settings.outputFiles.clear();
+				settings.estimateOutputFiles.clear();
+				settings.equationOutputFiles.clear();
+				output::settings.outputFiles.clear();
+			}
+
 			// Output to file is true but no specific files are specified, add default output file.
 			if(	 settings.outputToFile &&
 				!output::settings.outputFiles.size() &&
@@ -160,20 +207,36 @@ namespace chebyshev {
 
 			output::print_results(results.equationResults, settings.equationColumns, outputFiles);
 
-			std::cout << "Finished testing " << settings.moduleName << '\n';
-			std::cout << results.totalTests << " total tests, "
+			// Report the slowest test cases
+			timing::print_slowest(timing::take("prec"));
+
+			// Publish the termination of the module
+			metrics::end();
+
+			// Format the summary locally, as the formatting state
+			// of std::cout is shared by concurrent contexts
+			std::stringstream summary;
+			summary << "Finished testing " << settings.moduleName << '\n';
+			summary << results.totalTests << " total tests, "
 				<< results.failedTests << " failed (" << std::setprecision(3) <<
 				(results.failedTests / (double) results.totalTests) * 100 << "%)"
 				<< '\n';
+			std::cout << summary.str();
+
+			// Write updated results to the result cache
+			cache::save();
+
+			const unsigned int failedTests = results.failedTests;
 
 			// Discard previous results
 			results = prec_results();
 
 			if(exit) {
 				output::terminate();
-				std::exit(results.failedTests);
+				std::exit(failedTests);
 			}
 		}
+#endif
 
 
 		/// Estimate error integrals over a function
@@ -200,22 +263,50 @@ namespace chebyshev {
 				if(settings.pickedTests.find(name) == settings.pickedTests.end())
 					return;
 
-			// Use the estimator to estimate error integrals.
-			auto res = opt.estimator(funcApprox, funcExpected, opt);
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
 
-			res.name = name;
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			estimate_result res {};
+			std::string cacheKey;
+
+			if(cache::settings.enabled)
+				cacheKey = cache::key(name, cache::describe(opt));
+
+			// Use the estimator to estimate error integrals,
+			// unless a cached result can be reused.
+			if(!cache::lookup(cacheKey, res)) {
+
+				res = opt.estimator(funcApprox, funcExpected, opt);
+
+				// Estimators which may stop early report their iterations
+				if(!res.iterations)
+					res.iterations = opt.iterations;
+
+				cache::store(cacheKey, res);
+			}
+
+			res.name = res.cached ? (name + " [cached]") : name;
 			res.domain = opt.domain;
 			res.tolerance = opt.tolerance;
 			res.quiet = opt.quiet;
-			res.iterations = opt.iterations;
 
 			// Use the fail function to determine whether the test failed.
 			res.failed = opt.fail(res);
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
 			results.totalTests++;
 			if(res.failed)
 				results.failedTests++;
 
+			metrics::test_case("prec", res.name, res.failed);
+
 			results.estimateResults[name].push_back(res);
 		}
 
@@ -273,7 +364,7 @@ namespace chebyshev {
 		/// @param estimator The precision estimator to use
 		/// (defaults to the trapezoid<double> estimator).
 		/// @param quiet Whether to output the result.
-		inline void estimate(
+		CHEBYSHEV_INLINE void estimate(
 			const std::string& name,
 			EndoFunction<double> funcApprox,
 			EndoFunction<double> funcExpected,
@@ -282,7 +373,11 @@ namespace chebyshev {
 			unsigned int iterations = settings.defaultIterations,
 			FailFunction fail = fail::fail_on_max_err(),
 			Estimator<double, double> estimator = estimator::quadrature1D<double>(),
-			bool quiet = false) {
+			bool quiet = false)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			estimate_options<double, double> opt {};
 			opt.domain = { domain };
@@ -294,6 +389,300 @@ namespace chebyshev {
 
 			estimate(name, funcApprox, funcExpected, opt);
 		}
+#endif
+
+		/// Register the result of a precision estimate
+		/// computed at compile time by prec::static_estimate.
+		/// No function is evaluated at runtime.
+		///
+		/// @param name The name of the test case
+		/// @param staticResult The result of the compile time estimate
+		/// @param quiet Whether to output the result
+		CHEBYSHEV_INLINE void estimate(
+			const std::string& name,
+			const static_estimate_result& staticResult,
+			bool quiet = false)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			estimate_result res {};
+			res.name = name;
+			res.domain = { staticResult.domain };
+			res.tolerance = staticResult.tolerance;
+			res.maxErr = staticResult.maxErr;
+			res.meanErr = staticResult.meanErr;
+			res.rmsErr = staticResult.rmsErr;
+			res.relErr = staticResult.relErr;
+			res.absErr = staticResult.absErr;
+			res.iterations = staticResult.iterations;
+			res.failed = staticResult.failed;
+			res.quiet = quiet;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.estimateResults[name].push_back(res);
+		}
+#endif
+
+
+		/// Estimate error integrals of a generic approximation over
+		/// multiple floating point types at once, with respect to
+		/// a high precision reference function. The nodes are shared
+		/// between all types and the reference is evaluated only once
+		/// per node. A result is registered for each type, named after
+		/// the test case and the type (e.g. "sin(x) (float)"), with the
+		/// error in ULPs of the type stored in the "maxUlp" and "meanUlp"
+		/// additional fields. If rounding modes are given in the options,
+		/// a result is registered for each type and rounding mode
+		/// (e.g. "sin(x) (float, upward)"). The reference function is
+		/// evaluated in a type more precise than all the swept types,
+		/// which is long double, double_double or quad_double
+		/// (see sweep::default_reference) unless it is given as the
+		/// first template argument using sweep::reference_type.
+		/// Sweeping a type which is not less precise than the
+		/// reference type does not compile.
+		///
+		/// @param name The name of the test case
+		/// @param funcApprox The approximation to test, which must be
+		/// callable with each of the types (e.g. a generic lambda)
+		/// @param funcExpected The reference function, which must be
+		/// callable with the reference type
+		/// @param opt The options for the sweep
+		template<typename ...Types, typename Function1,
+			typename Function2 = EndoFunction<long double>>
+		inline void estimate_sweep(
+			const std::string& name,
+			Function1 funcApprox,
+			Function2 funcExpected,
+			const sweep_options& opt) {
+
+			using split = typename sweep::split<Types...>;
+
+			estimate_sweep(name, funcApprox, funcExpected, opt,
+				typename split::reference(), typename split::swept());
+		}
+
+
+		/// Estimate error integrals of a generic approximation over
+		/// multiple floating point types at once, with respect to
+		/// a reference function evaluated in the given reference type.
+		///
+		/// @param name The name of the test case
+		/// @param funcApprox The approximation to test
+		/// @param funcExpected The reference function
+		/// @param opt The options for the sweep
+		template<typename ReferenceType, typename ...Types,
+			typename Function1, typename Function2>
+		inline void estimate_sweep(
+			const std::string& name,
+			Function1 funcApprox,
+			Function2 funcExpected,
+			const sweep_options& opt,
+			sweep::reference_type<ReferenceType>,
+			sweep::types<Types...>) {
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			const std::vector<long double> x = sweep::nodes<Types...>(opt.domain, opt.iterations);
+
+			// Evaluate the reference once per node
+			std::vector<ReferenceType> expected (x.size());
+			for (size_t i = 0; i < x.size(); ++i)
+				expected[i] = ReferenceType(funcExpected(ReferenceType(x[i])));
+
+			// Evaluate each type under each rounding mode,
+			// switching the rounding mode once per batch of nodes.
+			std::vector<std::vector<estimate_result>> typeResults = {
+				sweep::estimate<Types>(funcApprox, x, expected, opt.domain, opt.roundingModes)...
+			};
+
+			const std::vector<std::string> typeNames = {
+				float_traits<Types>::name()...
+			};
+
+			// All types share the wall time of the whole sweep
+			const long double wallTime = watch.get();
+			const bool timedOut = timing::record("prec", name, wallTime);
+
+			for (size_t i = 0; i < typeResults.size(); ++i) {
+				for (size_t j = 0; j < typeResults[i].size(); ++j) {
+
+					estimate_result& res = typeResults[i][j];
+
+					res.name = name + " (" + typeNames[i];
+
+					if(opt.roundingModes.size())
+						res.name += ", " + sweep::rounding_name(opt.roundingModes[j]);
+
+					res.name += ")";
+					res.domain = { opt.domain };
+					res.tolerance = opt.tolerance;
+					res.quiet = opt.quiet;
+					res.iterations = x.size() - 1;
+					res.failed = opt.fail(res);
+					res.wallTime = wallTime;
+					res.failed = timedOut || res.failed;
+
+					results.totalTests++;
+					if(res.failed)
+						results.failedTests++;
+
+					metrics::test_case("prec", res.name, res.failed);
+
+					results.estimateResults[res.name].push_back(res);
+				}
+			}
+		}
+
+
+		/// Estimate error integrals of a generic approximation over
+		/// multiple floating point types at once, with respect to
+		/// a high precision reference function.
+		///
+		/// @param name The name of the test case
+		/// @param funcApprox The approximation to test
+		/// @param funcExpected The reference function
+		/// @param domain The domain of estimation
+		/// @param tolerance The tolerance on the maximum error in ULPs
+		/// @param iterations The number of quadrature subintervals
+		/// @param quiet Whether to output the result
+		template<typename ...Types, typename Function1,
+			typename Function2 = EndoFunction<long double>>
+		inline void estimate_sweep(
+			const std::string& name,
+			Function1 funcApprox,
+			Function2 funcExpected,
+			interval domain,
+			long double tolerance = CHEBYSHEV_PREC_ULP_TOLERANCE,
+			unsigned int iterations = settings.defaultIterations,
+			bool quiet = false) {
+
+			sweep_options opt (domain, tolerance, quiet);
+			opt.iterations = iterations;
+
+			estimate_sweep<Types...>(name, funcApprox, funcExpected, opt);
+		}
+
+		/// Estimate error integrals of a generic approximation of N real
+		/// variables by branch-and-bound with interval arithmetic. Both
+		/// functions must be generic in their arguments (e.g. generic
+		/// lambdas taking N arguments), so that they may be evaluated over
+		/// whole subdomains with prec::interval_number to prove the error
+		/// within tolerance, and sampled elsewhere, evaluating the
+		/// approximation in FloatType and the exact function in
+		/// ReferenceType (e.g. prec::double_double) on the same inputs.
+		/// The number of function evaluations is stored in the iterations
+		/// of the result and the fraction of the domain which was proven
+		/// within tolerance in the "proven" additional field.
+		///
+		/// @param name The name of the test case
+		/// @param funcApprox The approximation to test
+		/// @param funcExpected The exact function
+		/// @param opt The options of the estimate
+		template<unsigned int N = 1, typename FloatType = double,
+			typename ReferenceType = long double, typename Function1, typename Function2>
+		inline void estimate_bounded(
+			const std::string& name,
+			Function1 funcApprox,
+			Function2 funcExpected,
+			const bound_options& opt) {
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			estimate_result res = bound::estimate<N, FloatType, ReferenceType>(funcApprox, funcExpected, opt);
+			res.name = name;
+			res.domain = opt.domain;
+			res.tolerance = opt.tolerance;
+			res.quiet = opt.quiet;
+			res.failed = opt.fail(res);
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.estimateResults[name].push_back(res);
+		}
+
+
+		/// Estimate error integrals of a generic approximation of
+		/// a real variable by branch-and-bound with interval arithmetic.
+		///
+		/// @param name The name of the test case
+		/// @param funcApprox The approximation to test
+		/// @param funcExpected The exact function
+		/// @param domain The domain of estimation
+		/// @param tolerance The tolerance on the max absolute error
+		/// @param iterations The number of function evaluations
+		/// if no subdomain is proven within tolerance
+		/// @param quiet Whether to output the result
+		template<typename FloatType = double, typename ReferenceType = long double,
+			typename Function1, typename Function2>
+		inline void estimate_bounded(
+			const std::string& name,
+			Function1 funcApprox,
+			Function2 funcExpected,
+			interval domain,
+			long double tolerance = settings.defaultTolerance,
+			unsigned int iterations = settings.defaultIterations,
+			bool quiet = false) {
+
+			bound_options opt (domain, tolerance, quiet);
+			opt.iterations = iterations;
+
+			estimate_bounded<1, FloatType, ReferenceType>(name, funcApprox, funcExpected, opt);
+		}
 
 		/// @namespace chebyshev::prec::property Property testing of functions
 		///
@@ -416,6 +805,186 @@ namespace chebyshev {
 
 				estimate(name, funcApprox, funcExpected, opt);
 			}
+
+
+			/// Precision testing of multiple properties of a real
+			/// endofunction at once. All properties are checked over
+			/// the same nodes of Simpson's quadrature grid in a single
+			/// traversal of the domain, sharing the evaluations of the
+			/// function between properties (e.g. f(f(x)) is computed once
+			/// for both involution and idempotence). A result is registered
+			/// for each checked property, named after the test case and the
+			/// property (e.g. "f(x) (involution)"). Monotonicity errors are
+			/// measured as the decrease (or increase) of the function
+			/// between consecutive nodes.
+			///
+			/// @param name The name of the test case.
+			/// @param func The function to test.
+			/// @param props The properties to check.
+			/// @param opt The options for estimation (the domain must be
+			/// mono-dimensional and the estimator is not used).
+			template<typename Type = double, typename Function = EndoFunction<Type>>
+			inline void suite(
+				const std::string& name,
+				Function func,
+				const property_suite<Type>& props,
+				const estimate_options<Type, Type>& opt) {
+
+				if(opt.domain.size() != 1)
+					throw std::runtime_error(
+						"prec::property::suite only works on mono-dimensional domains");
+
+				// Skip the suite if any tests have been picked and
+				// neither the suite nor any of its properties were picked.
+				if(settings.pickedTests.size() &&
+					settings.pickedTests.find(name) == settings.pickedTests.end()) {
+
+					const std::string prefix = name + " (";
+					bool picked = false;
+
+					for (const auto& p : settings.pickedTests)
+						if(p.first.compare(0, prefix.size(), prefix) == 0)
+							picked = true;
+
+					if(!picked)
+						return;
+				}
+
+				// Skip the suite if it belongs to another shard.
+				if(!shard::selected(name))
+					return;
+
+				// Measure the wall time of the test case
+				const benchmark::timer watch;
+				metrics::start(name);
+
+				const std::vector<long double> x = sweep::nodes<Type>(opt.domain[0], opt.iterations);
+				const size_t n = x.size() - 1;
+				const long double length = opt.domain[0].length();
+				const long double dx = length / n;
+
+				const bool composed = props.involution || props.idempotence;
+				const bool parity = props.even || props.odd;
+				const bool periodic = (props.period != Type(0.0));
+				const bool inverse = bool(props.inverse);
+				const bool monotonic = props.increasing || props.decreasing;
+
+				sweep::accumulator identity, involution, idempotence,
+					homogeneous, even, odd, increasing, decreasing, period, inv;
+
+				Type previous = Type(0.0);
+
+				for (size_t i = 0; i <= n; ++i) {
+
+					const Type xi = Type(x[i]);
+					const long double w = sweep::weight(i, n);
+
+					// Evaluations shared between properties
+					const Type fx = func(xi);
+					const Type ffx = composed ? func(fx) : Type(0.0);
+					const Type fmx = parity ? func(-xi) : Type(0.0);
+
+					if(props.identity)
+						identity.add(std::abs(fx - xi), xi, w);
+
+					if(props.involution)
+						involution.add(std::abs(ffx - xi), xi, w);
+
+					if(props.idempotence)
+						idempotence.add(std::abs(ffx - fx), fx, w);
+
+					if(props.homogeneous)
+						homogeneous.add(std::abs(fx - props.zeroElement), props.zeroElement, w);
+
+					if(props.even)
+						even.add(std::abs(fmx - fx), fx, w);
+
+					if(props.odd)
+						odd.add(std::abs(fmx + fx), fx, w);
+
+					if(periodic)
+						period.add(std::abs(func(xi + props.period) - fx), fx, w);
+
+					if(inverse)
+						inv.add(std::abs(props.inverse(fx) - xi), xi, w);
+
+					if(monotonic) {
+
+						const Type decrease = (i > 0 && previous > fx) ? (previous - fx) : Type(0.0);
+						const Type increase = (i > 0 && fx > previous) ? (fx - previous) : Type(0.0);
+
+						// NaN values violate monotonicity
+						const bool isNan = (fx != fx);
+
+						increasing.add(isNan ? get_nan<long double>() : decrease, fx, w);
+						decreasing.add(isNan ? get_nan<long double>() : increase, fx, w);
+						previous = fx;
+					}
+				}
+
+				// All properties share the wall time of the evaluations
+				const long double wallTime = watch.get();
+				const bool timedOut = timing::record("prec", name, wallTime);
+
+				// Register the result of a single property
+				auto registerProperty = [&](const sweep::accumulator& acc, const std::string& propertyName) {
+
+					estimate_result res = acc.result(dx, length);
+
+					res.name = name + " (" + propertyName + ")";
+					res.domain = opt.domain;
+					res.tolerance = opt.tolerance;
+					res.quiet = opt.quiet;
+					res.iterations = n;
+					res.wallTime = wallTime;
+					res.failed = timedOut || opt.fail(res);
+
+					// Skip the property if any tests have been picked
+					// and neither it nor the test case were picked.
+					if(settings.pickedTests.size())
+						if(settings.pickedTests.find(name) == settings.pickedTests.end() &&
+							settings.pickedTests.find(res.name) == settings.pickedTests.end())
+							return;
+
+					results.totalTests++;
+					if(res.failed)
+						results.failedTests++;
+
+					metrics::test_case("prec", res.name, res.failed);
+
+					results.estimateResults[res.name].push_back(res);
+				};
+
+				if(props.identity)
+					registerProperty(identity, "identity");
+
+				if(props.involution)
+					registerProperty(involution, "involution");
+
+				if(props.idempotence)
+					registerProperty(idempotence, "idempotence");
+
+				if(props.homogeneous)
+					registerProperty(homogeneous, "homogeneous");
+
+				if(props.even)
+					registerProperty(even, "even");
+
+				if(props.odd)
+					registerProperty(odd, "odd");
+
+				if(periodic)
+					registerProperty(period, "periodic");
+
+				if(inverse)
+					registerProperty(inv, "inverse");
+
+				if(props.increasing)
+					registerProperty(increasing, "increasing");
+
+				if(props.decreasing)
+					registerProperty(decreasing, "decreasing");
+			}
 		}
 
 
@@ -438,6 +1007,14 @@ namespace chebyshev {
 				if(settings.pickedTests.find(name) == settings.pickedTests.end())
 					return;
 
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
 			equation_result res {};
 
 			long double diff = opt.distance(evaluated, expected);
@@ -452,10 +1029,15 @@ namespace chebyshev {
 			res.tolerance = opt.tolerance;
 			res.quiet = opt.quiet;
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
 			results.totalTests++;
 			if(res.failed)
 				results.failedTests++;
 
+			metrics::test_case("prec", res.name, res.failed);
+
 			// Register the result of the equation by name
 			results.equationResults[name].push_back(res);
 		}
@@ -495,11 +1077,15 @@ namespace chebyshev {
 		/// @param expected The expected value
 		/// @param tolerance The tolerance for the evaluation
 		/// @param quiet Whether to output the result
-		inline void equals(
+		CHEBYSHEV_INLINE void equals(
 			const std::string& name,
 			long double evaluated, long double expected,
 			long double tolerance = settings.defaultTolerance,
-			bool quiet = false) {
+			bool quiet = false)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
 
 			// Skip the test case if any tests have been picked
 			// and this one was not picked.
@@ -507,6 +1093,14 @@ namespace chebyshev {
 				if(settings.pickedTests.find(name) == settings.pickedTests.end())
 					return;
 
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
 			equation_result res {};
 
 			long double diff = distance::abs_distance(evaluated, expected);
@@ -524,13 +1118,71 @@ namespace chebyshev {
 			res.evaluated = evaluated;
 			res.expected = expected;
 
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
 			results.totalTests++;
 			if(res.failed)
 				results.failedTests++;
 
+			metrics::test_case("prec", res.name, res.failed);
+
 			// Register the result of the equation by name
 			results.equationResults[name].push_back(res);
 		}
+#endif
+
+
+		/// Register the result of an equation evaluated
+		/// at compile time by prec::static_equals.
+		///
+		/// @param name The name of the test case
+		/// @param staticResult The result of the compile time evaluation
+		/// @param quiet Whether to output the result
+		CHEBYSHEV_INLINE void equals(
+			const std::string& name,
+			const static_equation_result& staticResult,
+			bool quiet = false)
+#ifdef CHEBYSHEV_DECLARATIONS_ONLY
+		;
+#else
+		{
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			equation_result res {};
+			res.name = name;
+			res.evaluated = staticResult.evaluated;
+			res.expected = staticResult.expected;
+			res.difference = staticResult.difference;
+			res.tolerance = staticResult.tolerance;
+			res.failed = staticResult.failed;
+			res.quiet = quiet;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.equationResults[name].push_back(res);
+		}
+#endif
 
 
 		/// Evaluate multiple pairs of values for equivalence
@@ -543,7 +1195,7 @@ namespace chebyshev {
 		template<typename T>
 		inline void equals(
 			const std::string& name,
-			std::vector<std::array<T, 2>> values,
+			const std::vector<std::array<T, 2>>& values,
 			long double tolerance = settings.defaultTolerance,
 			bool quiet = false) {
 
@@ -553,9 +1205,448 @@ namespace chebyshev {
 				if(settings.pickedTests.find(name) == settings.pickedTests.end())
 					return;
 
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
 			for (const auto& v : values)
 				equals(name, v[0], v[1], tolerance, quiet);
 		}
+
+
+		/// Evaluate two arrays of values for element-wise equivalence
+		/// up to the given tolerance, with a custom distance function,
+		/// registering a single aggregated result. The distances are
+		/// computed in blocks, in a loop which the compiler may vectorize
+		/// when the distance function can be inlined. The result holds the
+		/// maximum distance as its difference and the additional fields
+		/// "count", "failures", "maxDiff", "meanDiff" and "worstIndex".
+		///
+		/// @param name The name of the test case
+		/// @param evaluated A pointer to the evaluated values
+		/// @param expected A pointer to the expected values
+		/// @param count The number of elements of both arrays
+		/// @param tolerance The tolerance on the distance of each pair
+		/// @param distance The distance function, taking two elements
+		/// and returning a real number (e.g. distance::abs_distance<double>)
+		/// @param quiet Whether to output the result
+		template<typename T, typename Distance>
+		inline void equals_all(
+			const std::string& name,
+			const T* evaluated, const T* expected,
+			size_t count,
+			long double tolerance,
+			Distance distance,
+			bool quiet = false) {
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			using Real = typename std::decay<decltype(distance(*evaluated, *expected))>::type;
+			const size_t blockSize = 256;
+			Real block[blockSize];
+
+			const Real tol = tolerance;
+			long double sum = 0;
+			Real maxDiff = 0;
+			size_t failures = 0;
+			size_t worstIndex = 0;
+			bool isNan = false;
+
+			for (size_t start = 0; start < count; start += blockSize) {
+
+				const size_t length = std::min(blockSize, count - start);
+
+				// Compute the distances of the block
+				for (size_t i = 0; i < length; ++i)
+					block[i] = distance(evaluated[start + i], expected[start + i]);
+
+				// Branch-free reductions over the block
+				Real blockSum = 0;
+				Real blockMax = 0;
+				size_t blockFailures = 0;
+
+				for (size_t i = 0; i < length; ++i) {
+					blockSum += block[i];
+					blockMax = block[i] > blockMax ? block[i] : blockMax;
+					blockFailures += !(block[i] <= tol);
+				}
+
+				sum += blockSum;
+				failures += blockFailures;
+
+				// NaN distances are always the worst
+				if(blockSum != blockSum && !isNan) {
+					for (size_t i = 0; i < length; ++i) {
+						if(block[i] != block[i]) {
+							worstIndex = start + i;
+							isNan = true;
+							break;
+						}
+					}
+				}
+
+				// Find the index of the worst pair only
+				// when the maximum has increased
+				if(blockMax > maxDiff || (start == 0 && length)) {
+
+					maxDiff = blockMax;
+
+					if(!isNan) {
+						for (size_t i = 0; i < length; ++i) {
+							if(block[i] == blockMax) {
+								worstIndex = start + i;
+								break;
+							}
+						}
+					}
+				}
+			}
+
+			equation_result res {};
+			res.name = name;
+			res.difference = isNan ? get_nan<long double>() : (long double) maxDiff;
+			res.tolerance = tolerance;
+			res.failed = failures > 0;
+			res.quiet = quiet;
+
+			res.additionalFields["count"] = count;
+			res.additionalFields["failures"] = failures;
+			res.additionalFields["maxDiff"] = res.difference;
+			res.additionalFields["meanDiff"] = count ? (sum / count) : 0;
+			res.additionalFields["worstIndex"] = worstIndex;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.equationResults[name].push_back(res);
+		}
+
+
+		/// Evaluate two arrays of real values for element-wise
+		/// equivalence up to the given tolerance, using the absolute
+		/// distance, registering a single aggregated result.
+		///
+		/// @param name The name of the test case
+		/// @param evaluated A pointer to the evaluated values
+		/// @param expected A pointer to the expected values
+		/// @param count The number of elements of both arrays
+		/// @param tolerance The tolerance on the distance of each pair
+		/// @param quiet Whether to output the result
+		template<typename T>
+		inline void equals_all(
+			const std::string& name,
+			const T* evaluated, const T* expected,
+			size_t count,
+			long double tolerance = settings.defaultTolerance,
+			bool quiet = false) {
+
+			equals_all(
+				name, evaluated, expected, count, tolerance,
+				[](T x, T y) { return x > y ? (x - y) : (y - x); },
+				quiet
+			);
+		}
+
+
+		/// Evaluate two vectors of values for element-wise equivalence
+		/// up to the given tolerance, with a custom distance function,
+		/// registering a single aggregated result.
+		///
+		/// @param name The name of the test case
+		/// @param evaluated The evaluated values
+		/// @param expected The expected values
+		/// @param tolerance The tolerance on the distance of each pair
+		/// @param distance The distance function to use
+		/// @param quiet Whether to output the result
+		template<typename T, typename Distance>
+		inline void equals_all(
+			const std::string& name,
+			const std::vector<T>& evaluated,
+			const std::vector<T>& expected,
+			long double tolerance,
+			Distance distance,
+			bool quiet = false) {
+
+			if(evaluated.size() != expected.size())
+				throw std::runtime_error(
+					"Size mismatch between evaluated and expected values in prec::equals_all");
+
+			equals_all(
+				name, evaluated.data(), expected.data(),
+				evaluated.size(), tolerance, distance, quiet
+			);
+		}
+
+
+		/// Evaluate two vectors of real values for element-wise
+		/// equivalence up to the given tolerance, using the absolute
+		/// distance, registering a single aggregated result.
+		///
+		/// @param name The name of the test case
+		/// @param evaluated The evaluated values
+		/// @param expected The expected values
+		/// @param tolerance The tolerance on the distance of each pair
+		/// @param quiet Whether to output the result
+		template<typename T>
+		inline void equals_all(
+			const std::string& name,
+			const std::vector<T>& evaluated,
+			const std::vector<T>& expected,
+			long double tolerance = settings.defaultTolerance,
+			bool quiet = false) {
+
+			if(evaluated.size() != expected.size())
+				throw std::runtime_error(
+					"Size mismatch between evaluated and expected values in prec::equals_all");
+
+			equals_all(
+				name, evaluated.data(), expected.data(),
+				evaluated.size(), tolerance, quiet
+			);
+		}
+
+
+		/// Evaluate two fixed-size arrays of real values for element-wise
+		/// equivalence up to the given tolerance, using the absolute
+		/// distance, registering a single aggregated result.
+		///
+		/// @param name The name of the test case
+		/// @param evaluated The evaluated values
+		/// @param expected The expected values
+		/// @param tolerance The tolerance on the distance of each pair
+		/// @param quiet Whether to output the result
+		template<typename T, size_t N>
+		inline void equals_all(
+			const std::string& name,
+			const std::array<T, N>& evaluated,
+			const std::array<T, N>& expected,
+			long double tolerance = settings.defaultTolerance,
+			bool quiet = false) {
+
+			equals_all(
+				name, evaluated.data(), expected.data(),
+				N, tolerance, quiet
+			);
+		}
+
+
+
+		/// Test the solution of a dense or sparse linear system Ax = b
+		/// by its normwise backward error |b - Ax| / (|A| |x| + |b|),
+		/// computed in extended precision, which is compared to a
+		/// relative tolerance (see prec::residual::solve).
+		///
+		/// @param name The name of the test case
+		/// @param A The matrix of the system
+		/// @param x The solution to test
+		/// @param b The right-hand side
+		/// @param opt The options of the residual test
+		template<typename Matrix, typename Type>
+		inline void equals_solve(
+			const std::string& name,
+			const Matrix& A,
+			const std::vector<Type>& x,
+			const std::vector<Type>& b,
+			const residual_options& opt = residual_options()) {
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			equation_result res = residual::solve(A, x, b, opt);
+			res.name = name;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.equationResults[name].push_back(res);
+		}
+
+
+		/// Test the product C = AB of two dense matrices by its
+		/// relative residual |C - AB| / (|A| |B|) in the Frobenius
+		/// norm (see prec::residual::product).
+		///
+		/// @param name The name of the test case
+		/// @param A The left factor
+		/// @param B The right factor
+		/// @param C The product to test
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline void equals_product(
+			const std::string& name,
+			const residual::dense_matrix<Type>& A,
+			const residual::dense_matrix<Type>& B,
+			const residual::dense_matrix<Type>& C,
+			const residual_options& opt = residual_options()) {
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			equation_result res = residual::product(A, B, C, opt);
+			res.name = name;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.equationResults[name].push_back(res);
+		}
+
+
+		/// Test a factorization A = LU of a dense matrix into two
+		/// factors by its relative residual |A - LU| / |A| in the
+		/// Frobenius norm (see prec::residual::factorization).
+		///
+		/// @param name The name of the test case
+		/// @param A The factorized matrix
+		/// @param L The left factor
+		/// @param U The right factor
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline void equals_factorization(
+			const std::string& name,
+			const residual::dense_matrix<Type>& A,
+			const residual::dense_matrix<Type>& L,
+			const residual::dense_matrix<Type>& U,
+			const residual_options& opt = residual_options()) {
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			equation_result res = residual::factorization(A, L, U, opt);
+			res.name = name;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.equationResults[name].push_back(res);
+		}
+
+
+		/// Test the orthonormality of the columns of a dense matrix
+		/// by the loss of orthogonality |Q^T Q - I| in the Frobenius
+		/// norm (see prec::residual::orthogonality).
+		///
+		/// @param name The name of the test case
+		/// @param Q The matrix with orthonormal columns to test
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline void equals_orthogonal(
+			const std::string& name,
+			const residual::dense_matrix<Type>& Q,
+			const residual_options& opt = residual_options()) {
+
+			// Skip the test case if any tests have been picked
+			// and this one was not picked.
+			if(settings.pickedTests.size())
+				if(settings.pickedTests.find(name) == settings.pickedTests.end())
+					return;
+
+			// Skip the test case if it belongs to another shard.
+			if(!shard::selected(name))
+				return;
+
+			// Measure the wall time of the test case
+			const benchmark::timer watch;
+			metrics::start(name);
+
+			equation_result res = residual::orthogonality(Q, opt);
+			res.name = name;
+
+			res.wallTime = watch.get();
+			res.failed = timing::record("prec", name, res.wallTime) || res.failed;
+
+			results.totalTests++;
+			if(res.failed)
+				results.failedTests++;
+
+			metrics::test_case("prec", res.name, res.failed);
+
+			results.equationResults[name].push_back(res);
+		}
+
+
+#ifdef CHEBYSHEV_COMPILED
+
+		// Instantiations for real functions of real variable,
+		// defined in the compiled library.
+		extern template void estimate<double, double>(
+			const std::string&, EndoFunction<double>, EndoFunction<double>,
+			estimate_options<double, double>);
+
+		extern template void equals<double>(
+			const std::string&, const double&, const double&,
+			equation_options<double>);
+
+#endif
 	}
 }
 
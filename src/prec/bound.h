@@ -0,0 +1,308 @@
+///
+/// @file bound.h Branch-and-bound estimation with interval arithmetic.
+///
+
+#ifndef CHEBYSHEV_BOUND_H
+#define CHEBYSHEV_BOUND_H
+
+#include <array>
+#include <deque>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <utility>
+#include <stdexcept>
+
+#include "../core/common.h"
+#include "../core/metrics.h"
+#include "./prec_structures.h"
+#include "./interval_number.h"
+#include "./box.h"
+#include "./estimator.h"
+
+
+namespace chebyshev {
+namespace prec {
+
+
+	/// @namespace chebyshev::prec::bound Branch-and-bound estimation
+	///
+	/// Generic functions of N real variables (e.g. generic lambdas
+	/// taking N arguments) are evaluated in interval arithmetic over
+	/// whole subdomains, to rigorously bound the error between an
+	/// approximation and the exact function using its second order
+	/// Taylor expansion around the center of the subdomain, with the
+	/// remainder bounded by the enclosure of the Hessian over the
+	/// subdomain (or the mean value form, if tighter).
+	/// Subdomains proven within tolerance are discarded after a single
+	/// evaluation, the others are bisected and, when they may not be
+	/// refined further, sampled. The bounds hold for the exact real
+	/// arithmetic semantics of the functions, so the rounding errors
+	/// of their floating point evaluation are not included.
+	namespace bound {
+
+
+		/// Call a function of N variables with the elements of an array.
+		template<typename Function, typename Type, size_t N, size_t ...I>
+		inline auto apply(Function f, const std::array<Type, N>& x, std::index_sequence<I...>) {
+			return f(x[I]...);
+		}
+
+
+		/// Call a function of N variables with the elements of an array.
+		template<typename Function, typename Type, size_t N>
+		inline auto apply(Function f, const std::array<Type, N>& x) {
+			return apply(f, x, std::make_index_sequence<N>());
+		}
+
+
+		/// @class bound_test
+		/// The result of bounding the error over a subdomain.
+		struct bound_test {
+
+			/// Rigorous upper bound of the error over the subdomain.
+			long double upper = 0;
+
+			/// Rigorous lower bound of the error at the center.
+			long double lower = 0;
+
+			/// Error at the center of the subdomain.
+			long double center = 0;
+
+			/// Value of the exact function at the center.
+			long double expected = 0;
+		};
+
+
+		/// Bound the error between two generic functions of N
+		/// variables over a box, using interval arithmetic.
+		///
+		/// @param funcApprox The approximation
+		/// @param funcExpected The exact function
+		/// @param b The box to bound the error over
+		template<unsigned int N, typename Function1, typename Function2>
+		inline bound_test test(Function1 funcApprox, Function2 funcExpected, const box& b) {
+
+			std::array<interval_taylor<N>, N> center;
+			std::array<interval_taylor<N>, N> x;
+			std::array<interval_number, N> radius;
+
+			for (unsigned int i = 0; i < N; ++i) {
+
+				const long double lower = std::min(b.sides[i].a, b.sides[i].b);
+				const long double upper = std::max(b.sides[i].a, b.sides[i].b);
+				const long double m = b.sides[i].midpoint();
+
+				center[i] = interval_taylor<N>::variable(interval_number(m), i);
+				x[i] = interval_taylor<N>::variable(interval_number(lower, upper), i);
+				radius[i] = interval_number(0, std::max(
+					(interval_number(m) - lower).b, (interval_number(upper) - m).b));
+			}
+
+			// Error and its derivatives at the center, and enclosure
+			// of the error and of its derivatives over the whole box
+			const interval_taylor<N> expectedCenter = apply(funcExpected, center);
+			const interval_taylor<N> diffCenter =
+				interval_taylor<N>(apply(funcApprox, center)) - expectedCenter;
+			const interval_taylor<N> diff =
+				interval_taylor<N>(apply(funcApprox, x)) - interval_taylor<N>(apply(funcExpected, x));
+
+			// Mean value form of the error
+			interval_number firstOrder = abs(diffCenter.value);
+			for (unsigned int i = 0; i < N; ++i)
+				firstOrder = firstOrder + abs(diff.grad[i]) * radius[i];
+
+			// Second order Taylor form of the error,
+			// with the remainder bounded by the Hessian
+			interval_number secondOrder = abs(diffCenter.value);
+			for (unsigned int i = 0; i < N; ++i) {
+
+				secondOrder = secondOrder + abs(diffCenter.grad[i]) * radius[i];
+
+				for (unsigned int j = 0; j < N; ++j)
+					secondOrder = secondOrder
+						+ interval_number(0.5) * abs(diff.hess[i][j]) * radius[i] * radius[j];
+			}
+
+			bound_test res;
+			res.upper = std::min({ firstOrder.b, secondOrder.b, diff.value.magnitude() });
+			res.lower = diffCenter.value.mignitude();
+			res.center = std::abs(diffCenter.value.midpoint());
+			res.expected = expectedCenter.value.midpoint();
+
+			return res;
+		}
+
+
+		/// Sample the error between two generic functions of N variables
+		/// over a box, at the centers of a regular grid of cells (midpoint
+		/// rule). The approximation is evaluated in FloatType, while the
+		/// exact function is evaluated in ReferenceType on the same inputs,
+		/// rounded to FloatType, and the error is computed in long double.
+		///
+		/// @param funcApprox The approximation
+		/// @param funcExpected The exact function
+		/// @param b The box to sample
+		/// @param samples The minimum number of samples
+		template<unsigned int N, typename FloatType, typename ReferenceType = long double,
+			typename Function1, typename Function2>
+		inline estimate_result sample(
+			Function1 funcApprox, Function2 funcExpected,
+			const box& b, unsigned int samples) {
+
+			const unsigned int k = std::max<unsigned int>(
+				std::ceil(std::pow((long double) samples, 1.0L / N) - 1E-09), 1);
+
+			unsigned int total = 1;
+			for (unsigned int i = 0; i < N; ++i)
+				total *= k;
+
+			long double sum = 0;
+			long double sumSqr = 0;
+			long double sumAbs = 0;
+			long double max = 0;
+
+			std::array<FloatType, N> x;
+			std::array<ReferenceType, N> xRef;
+
+			for (unsigned int n = 0; n < total; ++n) {
+
+				// Decompose the index of the cell along each dimension
+				unsigned int index = n;
+				for (unsigned int i = 0; i < N; ++i) {
+
+					const interval side = b.sides[i];
+					x[i] = side.a + (index % k + 0.5L) * (side.b - side.a) / k;
+					xRef[i] = ReferenceType((long double) x[i]);
+					index /= k;
+				}
+
+				const long double expected = static_cast<long double>(apply(funcExpected, xRef));
+				const long double diff = std::abs((long double) apply(funcApprox, x) - expected);
+
+				if(diff > max || diff != diff)
+					max = (max != max) ? max : diff;
+
+				sum += diff;
+				sumSqr += diff * diff;
+				sumAbs += std::abs(expected);
+			}
+
+			estimate_result res {};
+			res.maxErr = max;
+			res.meanErr = sum / total;
+			res.rmsErr = std::sqrt(sumSqr / total);
+			res.absErr = res.meanErr * b.volume();
+			res.relErr = sum / sumAbs;
+			res.iterations = total;
+			res.additionalFields["meanAbs"] = sumAbs / total;
+
+			return res;
+		}
+
+
+		/// Estimate the error between two generic functions of N variables
+		/// by branch-and-bound. Subdomains whose error is proven within
+		/// tolerance are estimated from their center only, with their
+		/// maximum error being at least the proven bound (which excludes
+		/// rounding errors), while the others are bisected up to the
+		/// maximum depth and number of subdomains and then sampled, with
+		/// a number of samples proportional to their volume. Samples
+		/// evaluate the approximation in FloatType and the exact function
+		/// in ReferenceType (see sample). The number of subdomains, the fraction of the
+		/// volume which was proven within tolerance and the largest bound
+		/// over the proven subdomains are stored in the "subdomains",
+		/// "proven" and "boundErr" additional fields.
+		///
+		/// @param funcApprox The approximation, generic in its arguments
+		/// @param funcExpected The exact function, generic in its arguments
+		/// @param opt The options of the estimate
+		template<unsigned int N, typename FloatType, typename ReferenceType = long double,
+			typename Function1, typename Function2>
+		inline estimate_result estimate(
+			Function1 funcApprox, Function2 funcExpected, const bound_options& opt) {
+
+			if(opt.domain.size() != N)
+				throw std::runtime_error(
+					"The domain's dimension does not match the number of variables in prec::bound::estimate");
+
+			const long double totalVolume = box(opt.domain).volume();
+
+			std::deque<std::pair<box, unsigned int>> queue = { { box(opt.domain), 0 } };
+			std::vector<box> leaves;
+			std::vector<estimate_result> leafResults;
+			std::vector<box> pending;
+
+			long double provenVolume = 0;
+			long double boundErr = 0;
+			size_t tested = 0;
+
+			// Bisect the subdomains breadth first, until they are
+			// proven within tolerance or they may not be refined
+			while(queue.size()) {
+
+				const box b = queue.front().first;
+				const unsigned int depth = queue.front().second;
+				queue.pop_front();
+
+				const bound_test t = test<N>(funcApprox, funcExpected, b);
+
+				tested++;
+				metrics::progress(tested, tested + queue.size() + pending.size());
+
+				if(t.upper <= opt.tolerance) {
+
+					// Estimate the statistics from the center of the subdomain,
+					// evaluated as in the sampled subdomains, and bound
+					// the maximum error by the proven bound
+					estimate_result res = sample<N, FloatType, ReferenceType>(funcApprox, funcExpected, b, 1);
+
+					if(res.maxErr == res.maxErr)
+						res.maxErr = std::max<long double>({ res.maxErr, t.center, t.upper });
+
+					leaves.push_back(b);
+					leafResults.push_back(res);
+					provenVolume += b.volume();
+					boundErr = std::max(boundErr, t.upper);
+					continue;
+				}
+
+				// Sample the subdomains whose error certainly exceeds
+				// the tolerance or which may not be bisected further
+				const size_t subdomains = leaves.size() + pending.size() + queue.size();
+
+				if(t.lower > opt.tolerance || depth >= opt.maxDepth ||
+					subdomains + 2 > opt.maxSubdomains) {
+
+					pending.push_back(b);
+					continue;
+				}
+
+				for (const box& child : b.bisect())
+					queue.emplace_back(child, depth + 1);
+			}
+
+			for (size_t i = 0; i < pending.size(); ++i) {
+
+				const box& b = pending[i];
+				const unsigned int samples = std::max<unsigned int>(
+					std::round(opt.iterations * b.volume() / totalVolume), 1);
+
+				leaves.push_back(b);
+				leafResults.push_back(sample<N, FloatType, ReferenceType>(funcApprox, funcExpected, b, samples));
+				metrics::progress(tested + i + 1, tested + pending.size());
+			}
+
+			estimate_result res = merge_estimates(leafResults, leaves);
+			res.additionalFields["subdomains"] = leaves.size();
+			res.additionalFields["proven"] = provenVolume / totalVolume;
+			res.additionalFields["boundErr"] = boundErr;
+
+			return res;
+		}
+
+	}
+
+}}
+
+#endif
@@ -0,0 +1,133 @@
+///
+/// @file box.h Multidimensional intervals over the real numbers.
+///
+
+#ifndef CHEBYSHEV_BOX_H
+#define CHEBYSHEV_BOX_H
+
+#include <vector>
+#include <stdexcept>
+
+#include "./interval.h"
+
+
+namespace chebyshev {
+
+	namespace prec {
+
+		/// @class box
+		/// A multidimensional interval (hyperrectangle), given by
+		/// the cartesian product of one interval per dimension.
+		/// Boxes may be split and bisected to decompose the domain
+		/// of an estimate into subdomains.
+		struct box {
+
+			/// The interval of each dimension.
+			std::vector<interval> sides {};
+
+
+			/// Construct an empty box.
+			box() {}
+
+
+			/// Construct a mono-dimensional box from an interval.
+			box(interval side) : sides({side}) {}
+
+
+			/// Construct a box from the interval of each dimension.
+			box(const std::vector<interval>& sides) : sides(sides) {}
+
+
+			/// Returns the number of dimensions of the box.
+			inline size_t dimensions() const {
+				return sides.size();
+			}
+
+
+			/// Returns the volume (measure) of the box.
+			inline long double volume() const {
+
+				long double v = 1;
+				for (const interval& side : sides)
+					v *= side.length();
+
+				return v;
+			}
+
+
+			/// Returns the index of the longest side of the box.
+			inline size_t longest() const {
+
+				size_t index = 0;
+				for (size_t i = 1; i < sides.size(); ++i)
+					if(sides[i].length() > sides[index].length())
+						index = i;
+
+				return index;
+			}
+
+
+			/// Split the box into equal parts along one dimension.
+			///
+			/// @param dim The index of the dimension to split along
+			/// @param parts The number of parts
+			/// @return A list of the resulting boxes, in order
+			inline std::vector<box> split(size_t dim, unsigned int parts) const {
+
+				if(dim >= sides.size())
+					throw std::out_of_range("Dimension out of range in prec::box::split");
+
+				if(!parts)
+					throw std::invalid_argument("Number of parts must be positive in prec::box::split");
+
+				std::vector<box> res (parts, *this);
+				const interval side = sides[dim];
+				const long double step = (side.b - side.a) / parts;
+
+				for (unsigned int i = 0; i < parts; ++i) {
+					res[i].sides[dim].a = side.a + i * step;
+					res[i].sides[dim].b = (i == parts - 1) ? side.b : (side.a + (i + 1) * step);
+				}
+
+				return res;
+			}
+
+
+			/// Split the box into equal parts along every
+			/// dimension, resulting in parts^dimensions boxes.
+			///
+			/// @param parts The number of parts for each dimension
+			/// @return A list of the resulting boxes
+			inline std::vector<box> split(unsigned int parts) const {
+
+				std::vector<box> res = { *this };
+
+				for (size_t dim = 0; dim < sides.size(); ++dim) {
+
+					std::vector<box> next;
+					next.reserve(res.size() * parts);
+
+					for (const box& b : res) {
+						const std::vector<box> pieces = b.split(dim, parts);
+						next.insert(next.end(), pieces.begin(), pieces.end());
+					}
+
+					res = next;
+				}
+
+				return res;
+			}
+
+
+			/// Bisect the box along its longest side.
+			///
+			/// @return The two halves of the box
+			inline std::vector<box> bisect() const {
+				return split(longest(), 2);
+			}
+		};
+
+	}
+}
+
+#endif
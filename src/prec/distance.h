@@ -15,8 +15,9 @@ namespace prec {
 
 
 		/// Absolute distance between two real values.
+		/// The function is constexpr and may be evaluated at compile time.
 		template<typename FloatType = double>
-		inline FloatType abs_distance(FloatType a, FloatType b) {
+		inline constexpr FloatType abs_distance(FloatType a, FloatType b) {
 
 			const FloatType diff = b - a;
 			return (diff > 0) ? diff : -diff;
@@ -9,23 +9,214 @@
 
 #include <functional>
 #include <cmath>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
 
 #include "../core/common.h"
 #include "../core/random.h"
+#include "../core/metrics.h"
 #include "./prec_structures.h"
+#include "./box.h"
+#include "./tail.h"
 
 
 namespace chebyshev {
 namespace prec {
 
 
+	/// Merge the results of precision estimates over disjoint
+	/// subdomains into a single result over their union. Mean and
+	/// RMS errors are weighted by the volume of each subdomain.
+	/// The relative error is computed from the mean absolute value
+	/// of the expected function over each subdomain, stored by the
+	/// estimators in the "meanAbs" additional field, or otherwise
+	/// recovered from the mean and relative errors.
+	///
+	/// @param results The results of the estimates over each subdomain
+	/// @param subdomains The subdomains, in the same order
+	/// @return The merged estimate result
+	inline estimate_result merge_estimates(
+		const std::vector<estimate_result>& results,
+		const std::vector<box>& subdomains) {
+
+		if(results.size() != subdomains.size())
+			throw std::runtime_error(
+				"Results and subdomains size mismatch in prec::merge_estimates");
+
+		long double volume = 0;
+		long double sumMean = 0;
+		long double sumSqr = 0;
+		long double sumAbsExpected = 0;
+		long double max = 0;
+
+		estimate_result res {};
+		res.absErr = 0;
+		res.iterations = 0;
+
+		for (size_t i = 0; i < results.size(); ++i) {
+
+			const estimate_result& r = results[i];
+			const long double v = subdomains[i].volume();
+
+			if(r.maxErr > max || r.maxErr != r.maxErr)
+				max = (max != max) ? max : r.maxErr;
+
+			volume += v;
+			sumMean += v * r.meanErr;
+			sumSqr += v * r.rmsErr * r.rmsErr;
+			res.absErr += r.absErr;
+			res.iterations += r.iterations;
+
+			// Integral of the absolute value of the
+			// expected function over the subdomain
+			const auto it = r.additionalFields.find("meanAbs");
+
+			if(it != r.additionalFields.end())
+				sumAbsExpected += v * it->second;
+			else if(r.relErr > 0 && r.relErr == r.relErr)
+				sumAbsExpected += v * r.meanErr / r.relErr;
+		}
+
+		res.maxErr = max;
+		res.meanErr = sumMean / volume;
+		res.rmsErr = std::sqrt(sumSqr / volume);
+		res.relErr = sumMean / sumAbsExpected;
+		res.additionalFields["meanAbs"] = sumAbsExpected / volume;
+
+		return res;
+	}
+
+
 	/// @namespace chebyshev::prec::estimator Precision estimators.
 	namespace estimator {
 
 
+		/// Quantile of the standard normal distribution,
+		/// using Acklam's rational approximation.
+		///
+		/// @param p The probability, in (0, 1)
+		inline long double normal_quantile(long double p) {
+
+			const long double a[] = {
+				-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+				1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00
+			};
+
+			const long double b[] = {
+				-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+				6.680131188771972e+01, -1.328068155288572e+01
+			};
+
+			const long double c[] = {
+				-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+				-2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00
+			};
+
+			const long double d[] = {
+				7.784695709041462e-03, 3.224671290700398e-01,
+				2.445134137142996e+00, 3.754408661907416e+00
+			};
+
+			const long double low = 0.02425;
+
+			// Lower and upper tails
+			if(p < low || p > 1 - low) {
+
+				const long double q = std::sqrt(-2 * std::log(p < low ? p : (1 - p)));
+				const long double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+					/ ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+
+				return p < low ? x : -x;
+			}
+
+			const long double q = p - 0.5;
+			const long double r = q * q;
+
+			return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+				/ (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+		}
+
+
+		/// Returns the quantile of the normal distribution used by early
+		/// acceptance in an estimate with the given number of iterations.
+		/// The criterion is checked every 64 samples, so the error probability
+		/// (1 - confidence) is divided between all the checks (Bonferroni
+		/// correction), for the confidence to hold for the whole estimate.
+		///
+		/// @param early The early termination options
+		/// @param iterations The maximum number of iterations of the estimate
+		inline long double accept_quantile(const early_options& early, unsigned int iterations) {
+
+			const unsigned int first = std::max<unsigned int>((early.minIterations + 63) / 64, 1);
+			const unsigned int last = iterations / 64;
+			const long double looks = (last >= first) ? (last - first + 1) : 1;
+
+			return normal_quantile(1 - (1 - early.confidence) / looks);
+		}
+
+
+		/// Returns whether a Monte Carlo estimate may be accepted before all
+		/// iterations, because the upper confidence bound of the error field
+		/// of the early acceptance criterion is within tolerance.
+		///
+		/// @param early The early termination options
+		/// @param tolerance The tolerance of the estimate
+		/// @param z The quantile of the bound (see accept_quantile)
+		/// @param n The number of samples
+		/// @param sum The sum of the sampled errors
+		/// @param sumSqr The sum of their squares
+		/// @param sumQuad The sum of their fourth powers
+		inline bool accept_early(
+			const early_options& early, long double tolerance, long double z,
+			long double n, long double sum, long double sumSqr, long double sumQuad) {
+
+			if(!early.accept.size() || n < early.minIterations || n < 2)
+				return false;
+
+			if(early.accept == "meanErr") {
+
+				const long double mean = sum / n;
+				const long double var = std::max(sumSqr / n - mean * mean, 0.0L) * n / (n - 1);
+
+				return mean + z * std::sqrt(var / n) <= tolerance;
+			}
+
+			if(early.accept == "rmsErr") {
+
+				const long double meanSqr = sumSqr / n;
+				const long double var = std::max(sumQuad / n - meanSqr * meanSqr, 0.0L) * n / (n - 1);
+
+				return std::sqrt(meanSqr + z * std::sqrt(var / n)) <= tolerance;
+			}
+
+			return false;
+		}
+
+
+		/// Result of an estimator which stopped at an error beyond
+		/// tolerance, as the test is then known to fail. Only the
+		/// maximum error and the iterations are determined.
+		///
+		/// @param max The maximum error before the last one
+		/// @param diff The last error
+		/// @param iterations The number of iterations used
+		inline estimate_result fail_fast(long double max, long double diff, unsigned int iterations) {
+
+			estimate_result res {};
+			res.maxErr = (diff != diff) ? diff : std::max(max, diff);
+			res.iterations = iterations;
+			return res;
+		}
+
+
 		/// Use Simpson's quadrature scheme to approximate error integrals
 		/// for univariate real functions (endofunctions on real number types).
-		/// The estimator is returned as a lambda function.
+		/// The number of iterations is rounded up to the next even number.
+		/// The estimator is returned as a lambda function. With the fail-fast
+		/// option, the estimator stops at the first error beyond tolerance,
+		/// leaving the error integrals undetermined.
 		template<typename FloatType = double>
 		inline auto quadrature1D() {
 
@@ -40,28 +231,39 @@ namespace prec {
 
 				interval domain = options.domain[0];
 
+				// Simpson's weights require an even number of subintervals
+				const unsigned int iterations = options.iterations + (options.iterations % 2);
+
 				FloatType sum = 0;
 				FloatType sumSqr = 0;
 				FloatType sumAbs = 0;
 				FloatType max = 0;
 
 				const FloatType length = domain.length();
-				const FloatType dx = length / options.iterations;
+				const FloatType dx = length / iterations;
 				FloatType x;
 				FloatType coeff;
 
+				const bool failFast = options.early.failFast;
+
 				FloatType diff = std::abs(funcApprox(domain.a) - funcExpected(domain.a));
 
+				if(failFast && !(diff <= options.tolerance))
+					return fail_fast(0, diff, 1);
+
 				sum += diff;
 				sumSqr += diff * diff;
 				sumAbs += std::abs(funcExpected(domain.a));
 				max = diff;
 
-				for (unsigned int i = 1; i < options.iterations; ++i) {
+				for (unsigned int i = 1; i < iterations; ++i) {
 
 					x = domain.a + i * dx;
 					diff = std::abs(funcApprox(x) - funcExpected(x));
 
+					if(failFast && !(diff <= options.tolerance))
+						return fail_fast(max, diff, i + 1);
+
 					if(diff > max)
 						max = diff;
 
@@ -72,11 +274,14 @@ namespace prec {
 
 					sum += coeff * diff;
 					sumSqr += coeff * diff * diff;
-					sumAbs += coeff * funcExpected(x);
+					sumAbs += coeff * std::abs(funcExpected(x));
 				}
 
 				diff = std::abs(funcApprox(domain.b) - funcExpected(domain.b));
 
+				if(failFast && !(diff <= options.tolerance))
+					return fail_fast(max, diff, iterations);
+
 				sum += diff;
 				sumSqr += diff * diff;
 				sumAbs += std::abs(funcExpected(domain.b));
@@ -90,6 +295,8 @@ namespace prec {
 				res.meanErr = (sum * dx / 3.0) / length;
 				res.rmsErr = std::sqrt((sumSqr * dx / 3.0) / length);
 				res.relErr = std::abs((sum * dx / 3.0) / (sumAbs * dx / 3.0));
+				res.iterations = iterations;
+				res.additionalFields["meanAbs"] = (sumAbs * dx / 3.0) / length;
 				
 				return res;
 			};
@@ -138,6 +345,9 @@ namespace prec {
 					const long double diff = (long double) resExpected > resApprox ?
 						(resExpected - resApprox) : (resApprox - resExpected);
 
+					if(options.early.failFast && !(diff <= options.tolerance))
+						return fail_fast(maxErr, diff, totalPoints + 1);
+
 					maxErr = std::max(maxErr, diff);
 					sumDiff += diff;
 					sumSqr += diff * diff;
@@ -151,6 +361,7 @@ namespace prec {
 				res.meanErr = totalPoints > 0 ? (sumDiff / totalPoints) : 0;
 				res.rmsErr = totalPoints > 0 ? (std::sqrt(sumSqr) / totalPoints) : 0;
 				res.relErr = sumDiff / sumAbs;
+				res.iterations = totalPoints;
 				return res;
 			};
 		}
@@ -158,7 +369,9 @@ namespace prec {
 
 		/// Use crude Monte Carlo integration to approximate error integrals
 		/// for univariate real functions. A uniform random sampler is used
-		/// to sample points over the one-dimensional domain
+		/// to sample points over the one-dimensional domain. If the tail
+		/// options are enabled, the maximum error is also extrapolated
+		/// from the largest sampled errors (see prec::tail).
 		template<typename FloatType = double>
 		inline auto montecarlo1D() {
 
@@ -166,7 +379,7 @@ namespace prec {
 			// as a lambda function
 			return [](
 				EndoFunction<FloatType> funcApprox,
-				EndoFunction<FloatType> fExpected,
+				EndoFunction<FloatType> funcExpected,
 				estimate_options<FloatType, FloatType> options) {
 
 				if(options.domain.size() != 1)
@@ -179,23 +392,48 @@ namespace prec {
 				FloatType max = 0;
 				const FloatType length = options.domain[0].length();
 
-				for (int i = 0; i < options.iterations; ++i) {
+				// Largest errors, for the estimate of the maximum error
+				tail::tail_heap largest (options.tail.size);
+
+				FloatType sumQuad = 0;
+				unsigned int n = 0;
+
+				const long double z = options.early.accept.size() ?
+					accept_quantile(options.early, options.iterations) : 0;
+
+				while(n < options.iterations) {
 					
 					FloatType x = random::uniform(options.domain[0].a, options.domain[0].b);
 					const FloatType diff = std::abs(funcApprox(x) - funcExpected(x));
 
-					max = std::max(max, diff);
+					max = (diff != diff) ? diff : std::max(max, diff);
+					largest.push(diff);
 					sum += diff;
 					sumSqr += diff * diff;
+					sumQuad += diff * diff * diff * diff;
 					sumAbs += std::abs(funcExpected(x));
+					n++;
+
+					// Stop once the test is known to fail or may be accepted
+					if(options.early.failFast && !(diff <= options.tolerance))
+						break;
+
+					if(n % 64 == 0 && accept_early(
+						options.early, options.tolerance, z, n, sum, sumSqr, sumQuad))
+						break;
 				}
 
 				estimate_result res {};
 				res.maxErr = max;
-				res.meanErr = sum / options.iterations;
-				res.absErr = sum * (length / options.iterations);
-				res.rmsErr = sumSqr * (length / options.iterations);
+				res.meanErr = sum / n;
+				res.absErr = sum * (length / n);
+				res.rmsErr = std::sqrt(sumSqr / n);
 				res.relErr = sum / sumAbs;
+				res.iterations = n;
+				res.additionalFields["meanAbs"] = sumAbs / n;
+
+				if(options.tail.size)
+					tail::estimate(largest, options.tail, res);
 
 				return res;
 			};
@@ -203,7 +441,9 @@ namespace prec {
 
 
 		/// Use crude Monte Carlo integration to approximate error integrals
-		/// for multivariate real functions.
+		/// for multivariate real functions. If the tail options are enabled,
+		/// the maximum error is also extrapolated from the largest sampled
+		/// errors (see prec::tail).
 		///
 		/// @param dimensions The dimension of the space of inputs
 		/// @note You may specify a custom vector type to use as input,
@@ -215,8 +455,8 @@ namespace prec {
 			// as a lambda function
 			return [dimensions](
 				std::function<FloatType(Vector)> funcApprox,
-				std::function<FloatType(Vector)> fExpected,
-				estimate_options<FloatType, FloatType> options) {
+				std::function<FloatType(Vector)> funcExpected,
+				estimate_options<FloatType, Vector> options) {
 
 				if(options.domain.size() != dimensions)
 					throw std::runtime_error(
@@ -236,32 +476,244 @@ namespace prec {
 
 				Vector x (dimensions);
 
-				for (int i = 0; i < options.iterations; ++i) {
+				// Largest errors, for the estimate of the maximum error
+				tail::tail_heap largest (options.tail.size);
+
+				FloatType sumQuad = 0;
+				unsigned int n = 0;
+
+				const long double z = options.early.accept.size() ?
+					accept_quantile(options.early, options.iterations) : 0;
+
+				while(n < options.iterations) {
 					
 					random::sample_uniform(x, options.domain);
 
 					const FloatType diff = std::abs(funcApprox(x) - funcExpected(x));
 
-					if(max < diff)
+					if(max < diff || diff != diff)
 						max = diff;
 
+					largest.push(diff);
+
 					sum += diff;
 					sumSqr += diff * diff;
+					sumQuad += diff * diff * diff * diff;
 					sumAbs += std::abs(funcExpected(x));
+					n++;
+
+					// Stop once the test is known to fail or may be accepted
+					if(options.early.failFast && !(diff <= options.tolerance))
+						break;
+
+					if(n % 64 == 0 && accept_early(
+						options.early, options.tolerance, z, n, sum, sumSqr, sumQuad))
+						break;
 				}
 
 				estimate_result res {};
 				res.maxErr = max;
-				res.meanErr = sum / options.iterations;
-				res.absErr = sum * (volume / options.iterations);
-				res.rmsErr = sumSqr * (volume / options.iterations);
+				res.meanErr = sum / n;
+				res.absErr = sum * (volume / n);
+				res.rmsErr = std::sqrt(sumSqr / n);
 				res.relErr = sum / sumAbs;
+				res.iterations = n;
+				res.additionalFields["meanAbs"] = sumAbs / n;
+
+				if(options.tail.size)
+					tail::estimate(largest, options.tail, res);
 
 				return res;
 			};
 		}
 
 
+
+
+		/// Decompose the domain of estimation into subdomains and
+		/// estimate the error over each one with the given estimator,
+		/// in parallel, merging the results into a single estimate.
+		/// Subdomains whose local estimate fails (using the fail function
+		/// and tolerance of the options) are recursively bisected along
+		/// their longest side and estimated again with the same number of
+		/// iterations, so that the regions with the largest errors are
+		/// sampled more densely, up to a maximum depth and number of
+		/// subdomains. The number of subdomains and refinements are stored
+		/// in the "subdomains" and "refinements" additional fields.
+		///
+		/// @param estimator The estimator to use on each subdomain
+		/// @param parts The number of parts to initially split
+		/// each dimension of the domain into
+		/// @param maxDepth The maximum number of refinements of a subdomain
+		/// @param maxSubdomains The maximum total number of subdomains
+		/// @param threads The number of threads to use
+		/// (defaults to the number of hardware threads)
+		/// @note The functions and the estimator must be safe
+		/// to call concurrently from different threads.
+		template<typename R, typename ...Args>
+		inline auto decomposition(
+			Estimator<R, Args...> estimator,
+			unsigned int parts = 2,
+			unsigned int maxDepth = 4,
+			unsigned int maxSubdomains = 256,
+			unsigned int threads = 0) {
+
+			return [=](
+				std::function<R(Args...)> funcApprox,
+				std::function<R(Args...)> funcExpected,
+				estimate_options<R, Args...> options) {
+
+				if(!options.domain.size())
+					throw std::runtime_error(
+						"estimator::decomposition requires a non-empty domain");
+
+				std::vector<box> leaves = box(options.domain).split(parts ? parts : 1);
+				std::vector<unsigned int> depth (leaves.size(), 0);
+
+				// Distribute the iterations between the initial subdomains,
+				// rounding up to an even number for Simpson's quadrature
+				unsigned int localIterations =
+					std::max<unsigned int>(options.iterations / leaves.size(), 2);
+				localIterations += localIterations % 2;
+
+				unsigned int workers = threads ? threads : std::thread::hardware_concurrency();
+				workers = workers ? workers : 1;
+
+				// Number of subdomains scheduled and estimated so far,
+				// published as the progress of the estimator
+				size_t scheduled = 0;
+				std::atomic<size_t> estimated {0};
+
+				// Estimate the error over a list of subdomains in parallel
+				auto estimateAll = [&](const std::vector<box>& subdomains) {
+
+					scheduled += subdomains.size();
+					metrics::progress(estimated, scheduled);
+
+					std::vector<estimate_result> res (subdomains.size());
+					std::vector<std::exception_ptr> errors (subdomains.size());
+					std::atomic<size_t> next {0};
+
+					// Each subdomain draws from its own engine, seeded by the
+					// calling thread, whatever the thread which estimates it
+					const std::vector<uint64_t> seeds = random::seeds(subdomains.size());
+					const random::xoshiro256 callerEngine = random::engine;
+
+					auto work = [&]() {
+						for (size_t i = next++; i < subdomains.size(); i = next++) {
+							try {
+								random::engine.seed(seeds[i]);
+
+								estimate_options<R, Args...> local = options;
+								local.domain = subdomains[i].sides;
+								local.iterations = localIterations;
+
+								res[i] = estimator(funcApprox, funcExpected, local);
+								res[i].domain = local.domain;
+								res[i].tolerance = local.tolerance;
+
+								if(!res[i].iterations)
+									res[i].iterations = local.iterations;
+
+								metrics::progress(++estimated, scheduled);
+							} catch(...) {
+								errors[i] = std::current_exception();
+							}
+						}
+					};
+
+					const size_t count = std::min<size_t>(workers, subdomains.size());
+					std::vector<std::thread> pool;
+
+					for (size_t t = 1; t < count; ++t)
+						pool.emplace_back(work);
+
+					work();
+					random::engine = callerEngine;
+
+					for (std::thread& t : pool)
+						t.join();
+
+					for (const std::exception_ptr& e : errors)
+						if(e)
+							std::rethrow_exception(e);
+
+					return res;
+				};
+
+				std::vector<estimate_result> leafResults = estimateAll(leaves);
+				unsigned int refinements = 0;
+
+				while(true) {
+
+					// Select the failing subdomains which may be refined,
+					// starting from the one with the largest error.
+					std::vector<size_t> failing;
+					for (size_t i = 0; i < leaves.size(); ++i)
+						if(depth[i] < maxDepth && options.fail(leafResults[i]))
+							failing.push_back(i);
+
+					std::sort(failing.begin(), failing.end(), [&](size_t i, size_t j) {
+						return leafResults[i].maxErr > leafResults[j].maxErr;
+					});
+
+					// Bisecting a subdomain adds one subdomain to the total
+					const size_t budget = leaves.size() < maxSubdomains ?
+						(maxSubdomains - leaves.size()) : 0;
+
+					if(failing.size() > budget)
+						failing.resize(budget);
+
+					if(!failing.size())
+						break;
+
+					std::vector<box> children;
+					std::vector<unsigned int> childDepth;
+
+					for (size_t i : failing) {
+						for (const box& child : leaves[i].bisect()) {
+							children.push_back(child);
+							childDepth.push_back(depth[i] + 1);
+						}
+					}
+
+					const std::vector<estimate_result> childResults = estimateAll(children);
+
+					// Replace the refined subdomains with their children
+					std::vector<bool> refined (leaves.size(), false);
+					for (size_t i : failing)
+						refined[i] = true;
+
+					std::vector<box> nextLeaves;
+					std::vector<unsigned int> nextDepth;
+					std::vector<estimate_result> nextResults;
+
+					for (size_t i = 0; i < leaves.size(); ++i) {
+						if(!refined[i]) {
+							nextLeaves.push_back(leaves[i]);
+							nextDepth.push_back(depth[i]);
+							nextResults.push_back(leafResults[i]);
+						}
+					}
+
+					nextLeaves.insert(nextLeaves.end(), children.begin(), children.end());
+					nextDepth.insert(nextDepth.end(), childDepth.begin(), childDepth.end());
+					nextResults.insert(nextResults.end(), childResults.begin(), childResults.end());
+
+					leaves = nextLeaves;
+					depth = nextDepth;
+					leafResults = nextResults;
+					refinements += failing.size();
+				}
+
+				estimate_result res = merge_estimates(leafResults, leaves);
+				res.additionalFields["subdomains"] = leaves.size();
+				res.additionalFields["refinements"] = refinements;
+
+				return res;
+			};
+		}
+
 	}
 
 }}
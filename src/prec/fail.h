@@ -64,6 +64,22 @@ namespace prec {
 			};
 		}
 
+
+		/// Marks the test as failed if the maximum error in ULPs,
+		/// stored in the "maxUlp" additional field by sweep estimation,
+		/// is bigger than the tolerance or is NaN or missing.
+		inline auto fail_on_max_ulp() {
+			return [](const estimate_result& r) -> bool {
+
+				const auto it = r.additionalFields.find("maxUlp");
+
+				if(it == r.additionalFields.end())
+					return true;
+
+				return (it->second > r.tolerance) || (it->second != it->second);
+			};
+		}
+
 	}
 }}
 
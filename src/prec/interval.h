@@ -13,6 +13,8 @@ namespace chebyshev {
 
 		/// @class interval
 		/// An interval on the real numbers.
+		/// All members are constexpr, so that intervals
+		/// may be used in compile time precision checks.
 		struct interval {
 
 			/// Lower extreme of the interval.
@@ -22,18 +24,24 @@ namespace chebyshev {
 			long double b;
 
 			/// Construct over the origin.
-			interval() : a(0), b(0) {}
+			constexpr interval() : a(0), b(0) {}
 
 
 			/// Construct an interval from its lower and upper bounds.
-			interval(long double l, long double r) : a(l), b(r) {}
+			constexpr interval(long double l, long double r) : a(l), b(r) {}
 
 
 			/// Returns the length of the interval
-			inline long double length() const {
+			inline constexpr long double length() const {
 				const long double diff = b - a;
 				return diff > 0 ? diff : -diff;
 			}
+
+
+			/// Returns the midpoint of the interval
+			inline constexpr long double midpoint() const {
+				return a + (b - a) / 2;
+			}
 		};
 
 	}
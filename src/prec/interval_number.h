@@ -0,0 +1,533 @@
+///
+/// @file interval_number.h Interval arithmetic with outward rounding.
+///
+
+#ifndef CHEBYSHEV_INTERVAL_NUMBER_H
+#define CHEBYSHEV_INTERVAL_NUMBER_H
+
+#include <cmath>
+#include <array>
+#include <limits>
+#include <algorithm>
+
+#include "../core/common.h"
+#include "./interval.h"
+
+
+namespace chebyshev {
+
+	namespace prec {
+
+
+		/// @class interval_number
+		/// A real number known to lie inside of an interval, which may
+		/// be used in place of a floating point type in generic functions
+		/// to compute a rigorous enclosure of their range over a whole
+		/// interval. The endpoints are rounded outwards after every
+		/// operation, so that the result always contains the exact
+		/// value of the expression (elementary functions are widened by
+		/// two ULPs, assuming the accuracy of the standard library).
+		/// Elementary functions must be called unqualified
+		/// (e.g. "using std::sin; sin(x)") to be found for this type.
+		struct interval_number {
+
+			/// Lower extreme of the interval.
+			long double a;
+
+			/// Upper extreme of the interval.
+			long double b;
+
+
+			/// Construct the point interval at zero.
+			interval_number() : a(0), b(0) {}
+
+
+			/// Construct a point interval.
+			interval_number(long double x) : a(x), b(x) {}
+
+
+			/// Construct an interval from its extremes.
+			interval_number(long double a, long double b) : a(a), b(b) {}
+
+
+			/// Construct an interval number from an interval.
+			interval_number(interval k) : a(k.a), b(k.b) {}
+
+
+			/// Returns the midpoint of the interval.
+			inline long double midpoint() const {
+				return a + (b - a) / 2;
+			}
+
+
+			/// Returns the width of the interval.
+			inline long double width() const {
+				return b - a;
+			}
+
+
+			/// Returns the magnitude of the interval, that is
+			/// the largest absolute value of its elements.
+			inline long double magnitude() const {
+				return std::max(std::abs(a), std::abs(b));
+			}
+
+
+			/// Returns the mignitude of the interval, that is
+			/// the smallest absolute value of its elements.
+			inline long double mignitude() const {
+
+				if(a <= 0 && b >= 0)
+					return 0;
+
+				return std::min(std::abs(a), std::abs(b));
+			}
+
+
+			/// Returns whether the interval is exactly zero.
+			inline bool is_zero() const {
+				return a == 0 && b == 0;
+			}
+
+
+			/// Returns whether the interval contains the given value.
+			inline bool contains(long double x) const {
+				return a <= x && x <= b;
+			}
+
+
+			/// Returns the smallest interval containing both intervals.
+			inline interval_number hull(const interval_number& other) const {
+				return interval_number(std::min(a, other.a), std::max(b, other.b));
+			}
+
+
+			/// Round the extremes of an interval outwards by the given
+			/// number of ULPs. NaN extremes are widened to infinity.
+			static inline interval_number outward(long double a, long double b, int ulps = 1) {
+
+				const long double inf = std::numeric_limits<long double>::infinity();
+
+				if(a != a)
+					a = -inf;
+
+				if(b != b)
+					b = inf;
+
+				for (int i = 0; i < ulps; ++i) {
+					a = std::nextafter(a, -inf);
+					b = std::nextafter(b, inf);
+				}
+
+				// Round subnormal extremes to the smallest normal number,
+				// as arithmetic on subnormal numbers is much slower
+				const long double min = std::numeric_limits<long double>::min();
+
+				if(std::abs(a) < min)
+					a = -min;
+
+				if(std::abs(b) < min)
+					b = min;
+
+				return interval_number(a, b);
+			}
+
+
+			inline interval_number& operator+=(const interval_number& other) {
+				return *this = *this + other;
+			}
+
+			inline interval_number& operator-=(const interval_number& other) {
+				return *this = *this - other;
+			}
+
+			inline interval_number& operator*=(const interval_number& other) {
+				return *this = *this * other;
+			}
+
+			inline interval_number& operator/=(const interval_number& other) {
+				return *this = *this / other;
+			}
+
+
+			inline friend interval_number operator+(const interval_number& x) {
+				return x;
+			}
+
+			inline friend interval_number operator-(const interval_number& x) {
+				return interval_number(-x.b, -x.a);
+			}
+
+
+			inline friend interval_number operator+(
+				const interval_number& x, const interval_number& y) {
+
+				// Sums with zero are exact
+				if(x.is_zero())
+					return y;
+
+				if(y.is_zero())
+					return x;
+
+				return outward(x.a + y.a, x.b + y.b);
+			}
+
+
+			inline friend interval_number operator-(
+				const interval_number& x, const interval_number& y) {
+
+				if(y.is_zero())
+					return x;
+
+				if(x.is_zero())
+					return -y;
+
+				return outward(x.a - y.b, x.b - y.a);
+			}
+
+
+			inline friend interval_number operator*(
+				const interval_number& x, const interval_number& y) {
+
+				// Products with zero are exact
+				if(x.is_zero() || y.is_zero())
+					return interval_number(0);
+
+				const long double p[] = { x.a * y.a, x.a * y.b, x.b * y.a, x.b * y.b };
+				return outward(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+			}
+
+
+			inline friend interval_number operator/(
+				const interval_number& x, const interval_number& y) {
+
+				const long double inf = std::numeric_limits<long double>::infinity();
+
+				// Division by an interval containing zero is unbounded
+				if(y.contains(0))
+					return interval_number(-inf, inf);
+
+				const long double q[] = { x.a / y.a, x.a / y.b, x.b / y.a, x.b / y.b };
+				return outward(*std::min_element(q, q + 4), *std::max_element(q, q + 4));
+			}
+		};
+
+
+		/// Absolute value of an interval number.
+		inline interval_number abs(const interval_number& x) {
+
+			if(x.a >= 0)
+				return x;
+
+			if(x.b <= 0)
+				return -x;
+
+			return interval_number(0, std::max(-x.a, x.b));
+		}
+
+
+		/// Integer power of an interval number.
+		inline interval_number pow(const interval_number& x, int n) {
+
+			if(n < 0)
+				return interval_number(1) / pow(x, -n);
+
+			interval_number res = 1;
+
+			// Even powers are non-negative
+			if(n % 2 == 0)
+				for (int i = 0; i < n; ++i)
+					res = res * abs(x);
+			else
+				for (int i = 0; i < n; ++i)
+					res = res * x;
+
+			return res;
+		}
+
+
+		/// Square root of an interval number,
+		/// restricted to the non-negative reals.
+		inline interval_number sqrt(const interval_number& x) {
+			return interval_number::outward(
+				std::sqrt(std::max(x.a, 0.0L)), std::sqrt(std::max(x.b, 0.0L)), 2);
+		}
+
+
+		/// Exponential of an interval number.
+		inline interval_number exp(const interval_number& x) {
+			return interval_number::outward(std::exp(x.a), std::exp(x.b), 2);
+		}
+
+
+		/// Natural logarithm of an interval number,
+		/// restricted to the positive reals.
+		inline interval_number log(const interval_number& x) {
+			return interval_number::outward(
+				std::log(std::max(x.a, 0.0L)), std::log(std::max(x.b, 0.0L)), 2);
+		}
+
+
+		/// Arctangent of an interval number.
+		inline interval_number atan(const interval_number& x) {
+			return interval_number::outward(std::atan(x.a), std::atan(x.b), 2);
+		}
+
+
+		/// Sine of an interval number.
+		inline interval_number sin(const interval_number& x) {
+
+			const long double pi = PI_CONST;
+
+			if(!(x.width() < 2 * pi))
+				return interval_number(-1, 1);
+
+			long double lower = std::min(std::sin(x.a), std::sin(x.b));
+			long double upper = std::max(std::sin(x.a), std::sin(x.b));
+
+			// Include the maxima and minima inside of the interval,
+			// erring on the side of inclusion at the extremes.
+			const long double eps = 4 * std::numeric_limits<long double>::epsilon()
+				* std::max(1.0L, x.magnitude());
+
+			const long double kMax = std::ceil((x.a - eps - pi / 2) / (2 * pi));
+			if(pi / 2 + 2 * pi * kMax <= x.b + eps)
+				upper = 1;
+
+			const long double kMin = std::ceil((x.a - eps + pi / 2) / (2 * pi));
+			if(-pi / 2 + 2 * pi * kMin <= x.b + eps)
+				lower = -1;
+
+			interval_number res = interval_number::outward(lower, upper, 2);
+			res.a = std::max(res.a, -1.0L);
+			res.b = std::min(res.b, 1.0L);
+
+			return res;
+		}
+
+
+		/// Cosine of an interval number.
+		inline interval_number cos(const interval_number& x) {
+			return sin(x + interval_number::outward(PI_CONST / 2, PI_CONST / 2));
+		}
+
+
+		/// @class interval_taylor
+		/// An enclosure of the value, of the gradient and of the Hessian
+		/// of a function of N variables over a box, computed by second
+		/// order forward automatic differentiation in interval arithmetic.
+		/// It may be used in place of a floating point type in generic
+		/// functions, to bound their second order Taylor remainder.
+		template<unsigned int N>
+		struct interval_taylor {
+
+			/// Enclosure of the value.
+			interval_number value;
+
+			/// Enclosure of the partial derivatives.
+			std::array<interval_number, N> grad;
+
+			/// Enclosure of the second partial derivatives.
+			std::array<std::array<interval_number, N>, N> hess;
+
+
+			/// Construct a constant.
+			interval_taylor(long double x = 0) : interval_taylor(interval_number(x)) {}
+
+
+			/// Construct a constant enclosure.
+			interval_taylor(interval_number x) : value(x) {
+
+				grad.fill(interval_number(0));
+				for (unsigned int i = 0; i < N; ++i)
+					hess[i].fill(interval_number(0));
+			}
+
+
+			/// Construct the enclosure of the i-th variable over an interval.
+			static inline interval_taylor variable(interval_number x, unsigned int i) {
+
+				interval_taylor res (x);
+				res.grad[i] = interval_number(1);
+				return res;
+			}
+
+
+			/// Apply the chain rule, given the enclosures of a function
+			/// of one variable and of its first and second derivatives
+			/// over the value of this enclosure.
+			inline interval_taylor chain(
+				interval_number f, interval_number df, interval_number d2f) const {
+
+				interval_taylor res (f);
+
+				for (unsigned int i = 0; i < N; ++i) {
+
+					res.grad[i] = df * grad[i];
+
+					for (unsigned int j = 0; j < N; ++j)
+						res.hess[i][j] = df * hess[i][j] + d2f * grad[i] * grad[j];
+				}
+
+				return res;
+			}
+
+
+			inline interval_taylor& operator+=(const interval_taylor& other) {
+				return *this = *this + other;
+			}
+
+			inline interval_taylor& operator-=(const interval_taylor& other) {
+				return *this = *this - other;
+			}
+
+			inline interval_taylor& operator*=(const interval_taylor& other) {
+				return *this = *this * other;
+			}
+
+			inline interval_taylor& operator/=(const interval_taylor& other) {
+				return *this = *this / other;
+			}
+
+
+			inline friend interval_taylor operator+(const interval_taylor& x) {
+				return x;
+			}
+
+			inline friend interval_taylor operator-(const interval_taylor& x) {
+				return x.chain(-x.value, interval_number(-1), interval_number(0));
+			}
+
+
+			inline friend interval_taylor operator+(
+				const interval_taylor& x, const interval_taylor& y) {
+
+				interval_taylor res (x.value + y.value);
+
+				for (unsigned int i = 0; i < N; ++i) {
+
+					res.grad[i] = x.grad[i] + y.grad[i];
+
+					for (unsigned int j = 0; j < N; ++j)
+						res.hess[i][j] = x.hess[i][j] + y.hess[i][j];
+				}
+
+				return res;
+			}
+
+
+			inline friend interval_taylor operator-(
+				const interval_taylor& x, const interval_taylor& y) {
+				return x + (-y);
+			}
+
+
+			inline friend interval_taylor operator*(
+				const interval_taylor& x, const interval_taylor& y) {
+
+				interval_taylor res (x.value * y.value);
+
+				for (unsigned int i = 0; i < N; ++i) {
+
+					res.grad[i] = x.grad[i] * y.value + x.value * y.grad[i];
+
+					for (unsigned int j = 0; j < N; ++j)
+						res.hess[i][j] = x.hess[i][j] * y.value + x.value * y.hess[i][j]
+							+ x.grad[i] * y.grad[j] + x.grad[j] * y.grad[i];
+				}
+
+				return res;
+			}
+
+
+			inline friend interval_taylor operator/(
+				const interval_taylor& x, const interval_taylor& y) {
+
+				const interval_number r = interval_number(1) / y.value;
+				return x * y.chain(r, -(r * r), interval_number(2) * r * r * r);
+			}
+		};
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> abs(const interval_taylor<N>& x) {
+
+			const long double inf = std::numeric_limits<long double>::infinity();
+
+			if(x.value.a >= 0)
+				return x;
+
+			if(x.value.b <= 0)
+				return -x;
+
+			// The second derivative is unbounded at zero
+			return x.chain(abs(x.value), interval_number(-1, 1), interval_number(-inf, inf));
+		}
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> pow(const interval_taylor<N>& x, int n) {
+
+			if(n == 0)
+				return interval_taylor<N>(1);
+
+			return x.chain(
+				pow(x.value, n),
+				interval_number(n) * pow(x.value, n - 1),
+				interval_number(n) * interval_number(n - 1) * pow(x.value, n - 2));
+		}
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> sqrt(const interval_taylor<N>& x) {
+
+			const interval_number s = sqrt(x.value);
+			const interval_number ds = interval_number(1) / (interval_number(2) * s);
+
+			return x.chain(s, ds, -(ds / (interval_number(2) * x.value)));
+		}
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> exp(const interval_taylor<N>& x) {
+
+			const interval_number e = exp(x.value);
+			return x.chain(e, e, e);
+		}
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> log(const interval_taylor<N>& x) {
+
+			const interval_number r = interval_number(1) / x.value;
+			return x.chain(log(x.value), r, -(r * r));
+		}
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> atan(const interval_taylor<N>& x) {
+
+			const interval_number r = interval_number(1) / (interval_number(1) + pow(x.value, 2));
+			return x.chain(atan(x.value), r, interval_number(-2) * x.value * r * r);
+		}
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> sin(const interval_taylor<N>& x) {
+
+			const interval_number s = sin(x.value);
+			return x.chain(s, cos(x.value), -s);
+		}
+
+
+		template<unsigned int N>
+		inline interval_taylor<N> cos(const interval_taylor<N>& x) {
+
+			const interval_number c = cos(x.value);
+			return x.chain(c, -sin(x.value), -c);
+		}
+
+	}
+}
+
+#endif
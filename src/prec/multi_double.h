@@ -0,0 +1,1177 @@
+///
+/// @file multi_double.h Double-double and quad-double arithmetic.
+///
+
+#ifndef CHEBYSHEV_MULTI_DOUBLE_H
+#define CHEBYSHEV_MULTI_DOUBLE_H
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "../core/common.h"
+
+
+namespace chebyshev {
+
+	namespace prec {
+
+
+		/// @namespace chebyshev::prec::multi_double Multiple double arithmetic
+		///
+		/// Real numbers are represented as the unevaluated sum of two
+		/// (double_double, about 106 bits of precision) or four
+		/// (quad_double, about 212 bits) non-overlapping doubles, using
+		/// error-free transformations of floating point sums and products.
+		/// Products are made exact using fused multiply-add when it is
+		/// fast on the target (FP_FAST_FMA, e.g. with -mfma), otherwise
+		/// using Dekker's splitting. These types are meant as fast, high
+		/// precision references for precision testing, in place of long
+		/// double or of arbitrary precision libraries. The elementary
+		/// functions are accurate to a few units in the last place of the
+		/// type for moderate arguments, which is far beyond the precision
+		/// of the double or long double functions under test. The algorithms
+		/// follow those of the QD library (Hida, Li and Bailey).
+		namespace multi_double {
+
+
+			/// Sum of two doubles with its exact rounding error.
+			inline double two_sum(double a, double b, double& err) {
+
+				const double s = a + b;
+				const double bb = s - a;
+				err = (a - (s - bb)) + (b - bb);
+				return s;
+			}
+
+
+			/// Sum of two doubles with its exact rounding error,
+			/// assuming that |a| >= |b|.
+			inline double quick_two_sum(double a, double b, double& err) {
+
+				const double s = a + b;
+				err = b - (s - a);
+				return s;
+			}
+
+
+			/// Split a double into two halves of 26 bits, using Dekker's
+			/// splitting. Numbers larger than 2^996 in magnitude are scaled
+			/// down before splitting, so that the splitting does not overflow.
+			inline void split(double a, double& hi, double& lo) {
+
+				const double splitter = 134217729.0;
+				const double threshold = 6.69692879491417e+299;
+
+				if(a > threshold || a < -threshold) {
+
+					a *= 3.7252902984619140625e-09;
+					const double t = splitter * a;
+					hi = t - (t - a);
+					lo = a - hi;
+					hi *= 268435456.0;
+					lo *= 268435456.0;
+					return;
+				}
+
+				const double t = splitter * a;
+				hi = t - (t - a);
+				lo = a - hi;
+			}
+
+
+			/// Product of two doubles with its exact rounding error.
+			inline double two_prod(double a, double b, double& err) {
+
+				const double p = a * b;
+
+#ifdef FP_FAST_FMA
+				err = std::fma(a, b, -p);
+#else
+				double ahi, alo, bhi, blo;
+				split(a, ahi, alo);
+				split(b, bhi, blo);
+
+				err = ((ahi * bhi - p) + ahi * blo + alo * bhi) + alo * blo;
+#endif
+				return p;
+			}
+
+
+			/// Sum of three doubles into a, b and c
+			/// with decreasing magnitude.
+			inline void three_sum(double& a, double& b, double& c) {
+
+				double t2, t3;
+				const double t1 = two_sum(a, b, t2);
+				a = two_sum(c, t1, t3);
+				b = two_sum(t2, t3, c);
+			}
+
+
+			/// Sum of three doubles into a and b
+			/// with decreasing magnitude.
+			inline void three_sum2(double& a, double& b, double c) {
+
+				double t2, t3;
+				const double t1 = two_sum(a, b, t2);
+				a = two_sum(c, t1, t3);
+				b = t2 + t3;
+			}
+
+
+			/// Accumulate c into the double-length accumulator (a, b),
+			/// returning the leading part which does not fit in it.
+			inline double quick_three_accum(double& a, double& b, double c) {
+
+				double s = two_sum(b, c, b);
+				s = two_sum(a, s, a);
+
+				if(a != 0 && b != 0)
+					return s;
+
+				if(b == 0) {
+					b = a;
+					a = s;
+				} else {
+					a = s;
+				}
+
+				return 0;
+			}
+
+
+			/// Renormalize four overlapping doubles into
+			/// non-overlapping ones of decreasing magnitude.
+			inline void renormalize(double& c0, double& c1, double& c2, double& c3) {
+
+				if(std::isinf(c0))
+					return;
+
+				double s0, s1, s2 = 0, s3 = 0;
+
+				s0 = quick_two_sum(c2, c3, c3);
+				s0 = quick_two_sum(c1, s0, c2);
+				c0 = quick_two_sum(c0, s0, c1);
+
+				s0 = c0;
+				s1 = c1;
+
+				if(s1 != 0) {
+
+					s1 = quick_two_sum(s1, c2, s2);
+
+					if(s2 != 0)
+						s2 = quick_two_sum(s2, c3, s3);
+					else
+						s1 = quick_two_sum(s1, c3, s2);
+
+				} else {
+
+					s0 = quick_two_sum(s0, c2, s1);
+
+					if(s1 != 0)
+						s1 = quick_two_sum(s1, c3, s2);
+					else
+						s0 = quick_two_sum(s0, c3, s1);
+				}
+
+				c0 = s0;
+				c1 = s1;
+				c2 = s2;
+				c3 = s3;
+			}
+
+
+			/// Renormalize five overlapping doubles into
+			/// four non-overlapping ones of decreasing magnitude.
+			inline void renormalize(double& c0, double& c1, double& c2, double& c3, double c4) {
+
+				if(std::isinf(c0))
+					return;
+
+				double s0, s1, s2 = 0, s3 = 0;
+
+				s0 = quick_two_sum(c3, c4, c4);
+				s0 = quick_two_sum(c2, s0, c3);
+				s0 = quick_two_sum(c1, s0, c2);
+				c0 = quick_two_sum(c0, s0, c1);
+
+				s0 = c0;
+				s1 = c1;
+
+				if(s1 != 0) {
+
+					s1 = quick_two_sum(s1, c2, s2);
+
+					if(s2 != 0) {
+
+						s2 = quick_two_sum(s2, c3, s3);
+
+						if(s3 != 0)
+							s3 += c4;
+						else
+							s2 = quick_two_sum(s2, c4, s3);
+
+					} else {
+
+						s1 = quick_two_sum(s1, c3, s2);
+
+						if(s2 != 0)
+							s2 = quick_two_sum(s2, c4, s3);
+						else
+							s1 = quick_two_sum(s1, c4, s2);
+					}
+
+				} else {
+
+					s0 = quick_two_sum(s0, c2, s1);
+
+					if(s1 != 0) {
+
+						s1 = quick_two_sum(s1, c3, s2);
+
+						if(s2 != 0)
+							s2 = quick_two_sum(s2, c4, s3);
+						else
+							s1 = quick_two_sum(s1, c4, s2);
+
+					} else {
+
+						s0 = quick_two_sum(s0, c3, s1);
+
+						if(s1 != 0)
+							s1 = quick_two_sum(s1, c4, s2);
+						else
+							s0 = quick_two_sum(s0, c4, s1);
+					}
+				}
+
+				c0 = s0;
+				c1 = s1;
+				c2 = s2;
+				c3 = s3;
+			}
+
+		}
+
+
+		/// @class double_double
+		/// A real number represented as the unevaluated sum of two
+		/// non-overlapping doubles, with about 106 bits of precision.
+		/// Elementary functions must be called unqualified
+		/// (e.g. "using std::sin; sin(x)") to be found for this type.
+		struct double_double {
+
+			/// Leading component.
+			double hi;
+
+			/// Trailing component.
+			double lo;
+
+
+			/// Construct the number zero.
+			double_double() : hi(0), lo(0) {}
+
+
+			/// Construct a number from a double.
+			double_double(double x) : hi(x), lo(0) {}
+
+
+			/// Construct a number from an integer.
+			double_double(int x) : hi(x), lo(0) {}
+
+
+			/// Construct a number from a long double, exactly
+			/// if its significand has at most 106 bits.
+			explicit double_double(long double x) : hi(x), lo(0) {
+
+				if(std::isfinite(hi))
+					lo = x - hi;
+			}
+
+
+			/// Construct a number from its components,
+			/// which are normalized.
+			double_double(double hi, double lo) {
+				this->hi = multi_double::quick_two_sum(hi, lo, this->lo);
+			}
+
+
+			/// Returns the leading component.
+			inline double leading() const {
+				return hi;
+			}
+
+
+			/// Round the number to a double.
+			inline explicit operator double() const {
+				return hi;
+			}
+
+
+			/// Round the number to a long double.
+			inline explicit operator long double() const {
+				return std::isfinite(hi) ? ((long double) hi + lo) : hi;
+			}
+
+
+			/// Relative precision of the type.
+			static inline double epsilon() {
+				return 4.93038065763132e-32;
+			}
+
+
+			/// Number of Newton iterations needed to refine
+			/// a double approximation to full precision.
+			static inline unsigned int iterations() {
+				return 2;
+			}
+
+
+			/// The constant Pi.
+			static inline double_double pi() {
+				return double_double(3.141592653589793, 1.2246467991473532e-16);
+			}
+
+
+			/// The natural logarithm of 2.
+			static inline double_double ln2() {
+				return double_double(0.6931471805599453, 2.3190468138462996e-17);
+			}
+
+
+			inline double_double& operator+=(const double_double& other) {
+				return *this = *this + other;
+			}
+
+			inline double_double& operator-=(const double_double& other) {
+				return *this = *this - other;
+			}
+
+			inline double_double& operator*=(const double_double& other) {
+				return *this = *this * other;
+			}
+
+			inline double_double& operator/=(const double_double& other) {
+				return *this = *this / other;
+			}
+
+
+			inline friend double_double operator+(const double_double& x) {
+				return x;
+			}
+
+			inline friend double_double operator-(const double_double& x) {
+
+				double_double res;
+				res.hi = -x.hi;
+				res.lo = -x.lo;
+				return res;
+			}
+
+
+			inline friend double_double operator+(const double_double& x, const double_double& y) {
+
+				using namespace multi_double;
+
+				double s2, t2;
+				double s1 = two_sum(x.hi, y.hi, s2);
+				const double t1 = two_sum(x.lo, y.lo, t2);
+
+				s2 += t1;
+				s1 = quick_two_sum(s1, s2, s2);
+				s2 += t2;
+
+				return double_double(s1, s2);
+			}
+
+
+			inline friend double_double operator-(const double_double& x, const double_double& y) {
+				return x + (-y);
+			}
+
+
+			inline friend double_double operator*(const double_double& x, const double_double& y) {
+
+				double p2;
+				const double p1 = multi_double::two_prod(x.hi, y.hi, p2);
+				p2 += x.hi * y.lo + x.lo * y.hi;
+
+				return double_double(p1, p2);
+			}
+
+
+			inline friend double_double operator/(const double_double& x, const double_double& y) {
+
+				// Long division, refining the quotient
+				// with the remainder of each step
+				const double q1 = x.hi / y.hi;
+				double_double r = x - double_double(q1) * y;
+
+				const double q2 = r.hi / y.hi;
+				r -= double_double(q2) * y;
+
+				const double q3 = r.hi / y.hi;
+
+				return double_double(q1, q2) + q3;
+			}
+
+
+			inline friend bool operator==(const double_double& x, const double_double& y) {
+				return x.hi == y.hi && x.lo == y.lo;
+			}
+
+			inline friend bool operator!=(const double_double& x, const double_double& y) {
+				return !(x == y);
+			}
+
+			inline friend bool operator<(const double_double& x, const double_double& y) {
+				return x.hi < y.hi || (x.hi == y.hi && x.lo < y.lo);
+			}
+
+			inline friend bool operator>(const double_double& x, const double_double& y) {
+				return y < x;
+			}
+
+			inline friend bool operator<=(const double_double& x, const double_double& y) {
+				return !(y < x);
+			}
+
+			inline friend bool operator>=(const double_double& x, const double_double& y) {
+				return !(x < y);
+			}
+		};
+
+
+		/// @class quad_double
+		/// A real number represented as the unevaluated sum of four
+		/// non-overlapping doubles, with about 212 bits of precision.
+		/// Elementary functions must be called unqualified
+		/// (e.g. "using std::sin; sin(x)") to be found for this type.
+		struct quad_double {
+
+			/// Components of decreasing magnitude.
+			double x[4];
+
+
+			/// Construct the number zero.
+			quad_double() : x{0, 0, 0, 0} {}
+
+
+			/// Construct a number from a double.
+			quad_double(double a) : x{a, 0, 0, 0} {}
+
+
+			/// Construct a number from an integer.
+			quad_double(int a) : x{(double) a, 0, 0, 0} {}
+
+
+			/// Construct a number from a double-double.
+			quad_double(const double_double& a) : x{a.hi, a.lo, 0, 0} {}
+
+
+			/// Construct a number from a long double, exactly
+			/// if its significand has at most 106 bits.
+			explicit quad_double(long double a) : quad_double(double_double(a)) {}
+
+
+			/// Construct a number from its components,
+			/// which are normalized.
+			quad_double(double c0, double c1, double c2, double c3) : x{c0, c1, c2, c3} {
+				multi_double::renormalize(x[0], x[1], x[2], x[3]);
+			}
+
+
+			/// Returns the leading component.
+			inline double leading() const {
+				return x[0];
+			}
+
+
+			/// Round the number to a double.
+			inline explicit operator double() const {
+				return x[0];
+			}
+
+
+			/// Round the number to a long double.
+			inline explicit operator long double() const {
+				return std::isfinite(x[0]) ? ((long double) x[0] + x[1] + x[2]) : x[0];
+			}
+
+
+			/// Round the number to a double-double.
+			inline explicit operator double_double() const {
+				return double_double(x[0], x[1] + x[2]);
+			}
+
+
+			/// Relative precision of the type.
+			static inline double epsilon() {
+				return 1.21543267145725e-63;
+			}
+
+
+			/// Number of Newton iterations needed to refine
+			/// a double approximation to full precision.
+			static inline unsigned int iterations() {
+				return 3;
+			}
+
+
+			/// The constant Pi.
+			static inline quad_double pi() {
+				return quad_double(3.141592653589793, 1.2246467991473532e-16,
+					-2.9947698097183397e-33, 1.1124542208633653e-49);
+			}
+
+
+			/// The natural logarithm of 2.
+			static inline quad_double ln2() {
+				return quad_double(0.6931471805599453, 2.3190468138462996e-17,
+					5.707708438416212e-34, -3.5824322106018114e-50);
+			}
+
+
+			inline quad_double& operator+=(const quad_double& other) {
+				return *this = *this + other;
+			}
+
+			inline quad_double& operator-=(const quad_double& other) {
+				return *this = *this - other;
+			}
+
+			inline quad_double& operator*=(const quad_double& other) {
+				return *this = *this * other;
+			}
+
+			inline quad_double& operator/=(const quad_double& other) {
+				return *this = *this / other;
+			}
+
+
+			inline friend quad_double operator+(const quad_double& a) {
+				return a;
+			}
+
+			inline friend quad_double operator-(const quad_double& a) {
+
+				quad_double res;
+				for (int i = 0; i < 4; ++i)
+					res.x[i] = -a.x[i];
+
+				return res;
+			}
+
+
+			inline friend quad_double operator+(const quad_double& a, const quad_double& b) {
+
+				using namespace multi_double;
+
+				// Merge the components by decreasing magnitude
+				// into a double-length accumulator (u, v)
+				double res[4] = { 0, 0, 0, 0 };
+				int i = 0, j = 0, k = 0;
+				double u, v, t;
+
+				if(std::abs(a.x[i]) > std::abs(b.x[j]))
+					u = a.x[i++];
+				else
+					u = b.x[j++];
+
+				if(std::abs(a.x[i]) > std::abs(b.x[j]))
+					v = a.x[i++];
+				else
+					v = b.x[j++];
+
+				u = quick_two_sum(u, v, v);
+
+				while(k < 4) {
+
+					if(i >= 4 && j >= 4) {
+
+						res[k] = u;
+						if(k < 3)
+							res[++k] = v;
+
+						break;
+					}
+
+					if(i >= 4)
+						t = b.x[j++];
+					else if(j >= 4)
+						t = a.x[i++];
+					else if(std::abs(a.x[i]) > std::abs(b.x[j]))
+						t = a.x[i++];
+					else
+						t = b.x[j++];
+
+					const double s = quick_three_accum(u, v, t);
+
+					if(s != 0)
+						res[k++] = s;
+				}
+
+				// Add the remaining components
+				for (; i < 4; ++i)
+					res[3] += a.x[i];
+
+				for (; j < 4; ++j)
+					res[3] += b.x[j];
+
+				return quad_double(res[0], res[1], res[2], res[3]);
+			}
+
+
+			inline friend quad_double operator-(const quad_double& a, const quad_double& b) {
+				return a + (-b);
+			}
+
+
+			inline friend quad_double operator*(const quad_double& a, const quad_double& b) {
+
+				using namespace multi_double;
+
+				double q0, q1, q2, q3, q4, q5;
+				double t0, t1;
+
+				// Products of order 1, eps and eps^2
+				double p0 = two_prod(a.x[0], b.x[0], q0);
+				double p1 = two_prod(a.x[0], b.x[1], q1);
+				double p2 = two_prod(a.x[1], b.x[0], q2);
+				double p3 = two_prod(a.x[0], b.x[2], q3);
+				double p4 = two_prod(a.x[1], b.x[1], q4);
+				double p5 = two_prod(a.x[2], b.x[0], q5);
+
+				three_sum(p1, p2, q0);
+
+				// Sum of the terms of order eps^2
+				three_sum(p2, q1, q2);
+				three_sum(p3, p4, p5);
+
+				double s0 = two_sum(p2, p3, t0);
+				double s1 = two_sum(q1, p4, t1);
+				double s2 = q2 + p5;
+				s1 = two_sum(s1, t0, t0);
+				s2 += t0 + t1;
+
+				// Terms of order eps^3
+				s1 += a.x[0] * b.x[3] + a.x[1] * b.x[2] + a.x[2] * b.x[1] + a.x[3] * b.x[0]
+					+ q0 + q3 + q4 + q5;
+
+				renormalize(p0, p1, s0, s1, s2);
+
+				quad_double res;
+				res.x[0] = p0;
+				res.x[1] = p1;
+				res.x[2] = s0;
+				res.x[3] = s1;
+				return res;
+			}
+
+
+			inline friend quad_double operator/(const quad_double& a, const quad_double& b) {
+
+				// Long division, refining the quotient
+				// with the remainder of each step
+				const double q0 = a.x[0] / b.x[0];
+				quad_double r = a - b * q0;
+
+				const double q1 = r.x[0] / b.x[0];
+				r -= b * q1;
+
+				const double q2 = r.x[0] / b.x[0];
+				r -= b * q2;
+
+				const double q3 = r.x[0] / b.x[0];
+				r -= b * q3;
+
+				double c0 = q0, c1 = q1, c2 = q2, c3 = q3;
+				multi_double::renormalize(c0, c1, c2, c3, r.x[0] / b.x[0]);
+
+				quad_double res;
+				res.x[0] = c0;
+				res.x[1] = c1;
+				res.x[2] = c2;
+				res.x[3] = c3;
+				return res;
+			}
+
+
+			inline friend bool operator==(const quad_double& a, const quad_double& b) {
+				return a.x[0] == b.x[0] && a.x[1] == b.x[1] && a.x[2] == b.x[2] && a.x[3] == b.x[3];
+			}
+
+			inline friend bool operator!=(const quad_double& a, const quad_double& b) {
+				return !(a == b);
+			}
+
+			inline friend bool operator<(const quad_double& a, const quad_double& b) {
+
+				for (int i = 0; i < 4; ++i)
+					if(a.x[i] != b.x[i])
+						return a.x[i] < b.x[i];
+
+				return false;
+			}
+
+			inline friend bool operator>(const quad_double& a, const quad_double& b) {
+				return b < a;
+			}
+
+			inline friend bool operator<=(const quad_double& a, const quad_double& b) {
+				return !(b < a);
+			}
+
+			inline friend bool operator>=(const quad_double& a, const quad_double& b) {
+				return !(a < b);
+			}
+		};
+
+
+		/// Multiply a double-double by an integer power of 2.
+		inline double_double ldexp(const double_double& x, int n) {
+
+			double_double res;
+			res.hi = std::ldexp(x.hi, n);
+			res.lo = std::ldexp(x.lo, n);
+			return res;
+		}
+
+
+		/// Multiply a quad-double by an integer power of 2.
+		inline quad_double ldexp(const quad_double& x, int n) {
+
+			quad_double res;
+			for (int i = 0; i < 4; ++i)
+				res.x[i] = std::ldexp(x.x[i], n);
+
+			return res;
+		}
+
+
+		namespace multi_double {
+
+
+			/// Whether a term of a series is negligible
+			/// with respect to its partial sum.
+			template<typename T>
+			inline bool negligible(const T& term, const T& sum) {
+				return std::abs(term.leading()) <= std::abs(sum.leading()) * T::epsilon();
+			}
+
+
+			/// Integer power of a multiple double, by repeated squaring.
+			template<typename T>
+			inline T pow(const T& x, int n) {
+
+				T res = 1;
+				T base = x;
+
+				for (unsigned int m = std::abs(n); m; m >>= 1) {
+
+					if(m & 1)
+						res *= base;
+
+					base *= base;
+				}
+
+				return n < 0 ? (T(1) / res) : res;
+			}
+
+
+			/// Square root of a multiple double, refining the inverse
+			/// square root of its leading component by Newton's method.
+			template<typename T>
+			inline T sqrt(const T& a) {
+
+				if(a.leading() <= 0)
+					return a.leading() == 0 ? T(0) : T(std::numeric_limits<double>::quiet_NaN());
+
+				if(std::isinf(a.leading()))
+					return a;
+
+				const T h = ldexp(a, -1);
+				T x = 1.0 / std::sqrt(a.leading());
+
+				for (unsigned int i = 0; i < T::iterations(); ++i)
+					x += x * (0.5 - h * x * x);
+
+				return a * x;
+			}
+
+
+			/// Exponential of a multiple double. The argument is reduced
+			/// to r = (a - m ln 2) / 1024, the Taylor series of exp(r) - 1
+			/// is summed and the result is squared back.
+			template<typename T>
+			inline T exp(const T& a) {
+
+				const double x = a.leading();
+
+				if(x != x)
+					return a;
+
+				if(x > 709.782712893384)
+					return T(std::numeric_limits<double>::infinity());
+
+				if(x < -745.1332191019412)
+					return T(0);
+
+				const int k = 10;
+				const double m = std::floor(x / T::ln2().leading() + 0.5);
+				const T r = ldexp(a - T::ln2() * m, -k);
+
+				T s = r;
+				T term = r;
+
+				for (unsigned int n = 2; n < 100; ++n) {
+
+					term = term * r / double(n);
+					s += term;
+
+					if(negligible(term, s))
+						break;
+				}
+
+				// exp(2r) - 1 = (exp(r) - 1)(exp(r) + 1)
+				for (int i = 0; i < k; ++i)
+					s = s * (s + 2.0);
+
+				return ldexp(s + 1.0, (int) m);
+			}
+
+
+			/// Natural logarithm of a multiple double, refining the
+			/// logarithm of its leading component by Newton's method.
+			template<typename T>
+			inline T log(const T& a) {
+
+				if(a.leading() <= 0) {
+
+					return a.leading() == 0 ?
+						T(-std::numeric_limits<double>::infinity()) :
+						T(std::numeric_limits<double>::quiet_NaN());
+				}
+
+				if(std::isinf(a.leading()) || a.leading() != a.leading())
+					return a;
+
+				if(a == T(1))
+					return T(0);
+
+				T x = std::log(a.leading());
+
+				for (unsigned int i = 0; i < T::iterations(); ++i)
+					x += a * exp(-x) - 1.0;
+
+				return x;
+			}
+
+
+			/// Sine and cosine of a multiple double. The argument
+			/// is reduced modulo Pi / 2 and the Taylor series of the
+			/// sine and cosine of the remainder are summed.
+			template<typename T>
+			inline void sin_cos(const T& a, T& s, T& c) {
+
+				if(!std::isfinite(a.leading())) {
+					s = T(std::numeric_limits<double>::quiet_NaN());
+					c = s;
+					return;
+				}
+
+				const T halfPi = ldexp(T::pi(), -1);
+				const double j = std::floor(a.leading() / halfPi.leading() + 0.5);
+				const T r = a - halfPi * j;
+				const T r2 = r * r;
+
+				T sinr = r;
+				T cosr = 1;
+				T term = r;
+
+				for (unsigned int n = 1; n < 100; ++n) {
+
+					term = -term * r2 / double((2 * n) * (2 * n + 1));
+					sinr += term;
+
+					if(negligible(term, sinr))
+						break;
+				}
+
+				term = 1;
+
+				for (unsigned int n = 1; n < 100; ++n) {
+
+					term = -term * r2 / double((2 * n - 1) * (2 * n));
+					cosr += term;
+
+					if(negligible(term, cosr))
+						break;
+				}
+
+				// Select the quadrant of the argument
+				switch((int) (std::fmod(j, 4.0) + 4) % 4) {
+					case 0: s = sinr; c = cosr; break;
+					case 1: s = cosr; c = -sinr; break;
+					case 2: s = -sinr; c = -cosr; break;
+					default: s = -cosr; c = sinr; break;
+				}
+			}
+
+
+			/// Arctangent of a multiple double, refining the arctangent
+			/// of its leading component by Newton's method.
+			template<typename T>
+			inline T atan(const T& a) {
+
+				if(a.leading() == 0 || a.leading() != a.leading())
+					return a;
+
+				// atan(a) = sign(a) Pi / 2 - atan(1 / a)
+				if(std::abs(a.leading()) > 1) {
+
+					const T halfPi = ldexp(T::pi(), -1);
+					return (a.leading() > 0 ? halfPi : -halfPi) - atan(T(1) / a);
+				}
+
+				T z = std::atan(a.leading());
+				T s, c;
+
+				for (unsigned int i = 0; i < T::iterations(); ++i) {
+					sin_cos(z, s, c);
+					z += (a * c - s) * c;
+				}
+
+				return z;
+			}
+
+
+			/// Real power of a multiple double.
+			template<typename T>
+			inline T pow(const T& x, const T& y) {
+
+				// Integer exponents are computed exactly
+				// and allow negative bases
+				const double n = y.leading();
+
+				if(T(std::floor(n)) == y && std::abs(n) < 1E+09)
+					return pow(x, (int) n);
+
+				if(x.leading() == 0)
+					return T(0);
+
+				return exp(y * log(x));
+			}
+
+		}
+
+
+		/// Absolute value of a double-double.
+		inline double_double abs(const double_double& x) {
+			return x.hi < 0 ? -x : x;
+		}
+
+		/// Integer power of a double-double.
+		inline double_double pow(const double_double& x, int n) {
+			return multi_double::pow(x, n);
+		}
+
+		/// Real power of a double-double.
+		inline double_double pow(const double_double& x, const double_double& y) {
+			return multi_double::pow(x, y);
+		}
+
+		/// Square root of a double-double.
+		inline double_double sqrt(const double_double& x) {
+			return multi_double::sqrt(x);
+		}
+
+		/// Exponential of a double-double.
+		inline double_double exp(const double_double& x) {
+			return multi_double::exp(x);
+		}
+
+		/// Natural logarithm of a double-double.
+		inline double_double log(const double_double& x) {
+			return multi_double::log(x);
+		}
+
+		/// Sine of a double-double.
+		inline double_double sin(const double_double& x) {
+
+			double_double s, c;
+			multi_double::sin_cos(x, s, c);
+			return s;
+		}
+
+		/// Cosine of a double-double.
+		inline double_double cos(const double_double& x) {
+
+			double_double s, c;
+			multi_double::sin_cos(x, s, c);
+			return c;
+		}
+
+		/// Tangent of a double-double.
+		inline double_double tan(const double_double& x) {
+
+			double_double s, c;
+			multi_double::sin_cos(x, s, c);
+			return s / c;
+		}
+
+		/// Arctangent of a double-double.
+		inline double_double atan(const double_double& x) {
+			return multi_double::atan(x);
+		}
+
+
+		/// Absolute value of a quad-double.
+		inline quad_double abs(const quad_double& x) {
+			return x.x[0] < 0 ? -x : x;
+		}
+
+		/// Integer power of a quad-double.
+		inline quad_double pow(const quad_double& x, int n) {
+			return multi_double::pow(x, n);
+		}
+
+		/// Real power of a quad-double.
+		inline quad_double pow(const quad_double& x, const quad_double& y) {
+			return multi_double::pow(x, y);
+		}
+
+		/// Square root of a quad-double.
+		inline quad_double sqrt(const quad_double& x) {
+			return multi_double::sqrt(x);
+		}
+
+		/// Exponential of a quad-double.
+		inline quad_double exp(const quad_double& x) {
+			return multi_double::exp(x);
+		}
+
+		/// Natural logarithm of a quad-double.
+		inline quad_double log(const quad_double& x) {
+			return multi_double::log(x);
+		}
+
+		/// Sine of a quad-double.
+		inline quad_double sin(const quad_double& x) {
+
+			quad_double s, c;
+			multi_double::sin_cos(x, s, c);
+			return s;
+		}
+
+		/// Cosine of a quad-double.
+		inline quad_double cos(const quad_double& x) {
+
+			quad_double s, c;
+			multi_double::sin_cos(x, s, c);
+			return c;
+		}
+
+		/// Tangent of a quad-double.
+		inline quad_double tan(const quad_double& x) {
+
+			quad_double s, c;
+			multi_double::sin_cos(x, s, c);
+			return s / c;
+		}
+
+		/// Arctangent of a quad-double.
+		inline quad_double atan(const quad_double& x) {
+			return multi_double::atan(x);
+		}
+
+
+		/// @class round_to
+		/// Rounding of multiple double numbers to a floating point type,
+		/// rounding only once where possible. Types other than float,
+		/// double and long double are converted through long double.
+		template<typename FloatType>
+		struct round_to {
+
+			template<typename Type>
+			static FloatType from(const Type& v) {
+				return (FloatType) (long double) v;
+			}
+		};
+
+
+		/// Rounding of multiple double numbers to double,
+		/// which is their leading component.
+		template<>
+		struct round_to<double> {
+
+			template<typename Type>
+			static double from(const Type& v) {
+				return static_cast<double>(v);
+			}
+		};
+
+
+		/// Rounding of multiple double numbers to long double,
+		/// which sums their components in long double.
+		template<>
+		struct round_to<long double> {
+
+			template<typename Type>
+			static long double from(const Type& v) {
+				return static_cast<long double>(v);
+			}
+		};
+
+
+		/// Rounding of multiple double numbers to float, which rounds
+		/// the leading component and corrects the result if it was
+		/// exactly halfway between two floats, using the sign of the rest.
+		template<>
+		struct round_to<float> {
+
+			template<typename Type>
+			static float from(const Type& v) {
+
+				const double hi = static_cast<double>(v);
+				float r = (float) hi;
+
+				const double d = hi - (double) r;
+
+				if(d == 0 || d != d)
+					return r;
+
+				const double lo = static_cast<double>(v - Type(hi));
+				const float other = std::nextafter(r, d > 0 ?
+					std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity());
+
+				// The leading component is halfway and the rest
+				// points away from the rounded value
+				if(std::abs((double) other - hi) == std::abs(d) && lo != 0 && ((lo > 0) == (d > 0)))
+					r = other;
+
+				return r;
+			}
+		};
+
+
+		/// Wrap a generic function (e.g. a generic lambda using unqualified
+		/// elementary functions) into a real function of real variable,
+		/// which evaluates it in the given multiple double type, as a fast
+		/// high precision reference for prec::estimate. The result is
+		/// rounded once to FloatType (see round_to).
+		///
+		/// @param f The generic function to evaluate
+		template<typename Type = double_double, typename FloatType = double, typename Function>
+		inline auto reference(Function f) {
+			return [f](FloatType x) -> FloatType {
+				return round_to<FloatType>::from(f(Type((long double) x)));
+			};
+		}
+
+	}
+}
+
+#endif
@@ -8,6 +8,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <functional>
 
 #include "../core/common.h"
@@ -59,6 +60,12 @@ namespace chebyshev {
 
 			/// Total number of iterations for integral quadrature.
 			unsigned int iterations {0};
+
+			/// Whether the result was read from the result cache.
+			bool cached = false;
+
+			/// Wall time spent on the test case, in milliseconds.
+			long double wallTime = 0;
 		};
 
 
@@ -66,6 +73,57 @@ namespace chebyshev {
 		using FailFunction = std::function<bool(const estimate_result&)>;
 
 
+		/// @class tail_options
+		/// Options for the extreme value estimate of the maximum error
+		/// by Monte Carlo estimators (see prec::tail).
+		struct tail_options {
+
+			/// Number of the largest errors to keep for the fit
+			/// of the tail (the estimate is disabled if zero).
+			unsigned int size = 0;
+
+			/// Confidence level of the upper bound on the maximum error
+			/// and of the number of samples needed to observe it.
+			long double confidence = 0.95;
+
+			/// Number of bootstrap resamples for the upper bound.
+			unsigned int resamples = 200;
+
+			/// Fraction of the extrapolated maximum error which
+			/// the number of needed samples refers to.
+			long double level = 0.99;
+
+			/// For unbounded tails, the extrapolated maximum error is the
+			/// expected maximum of this many times the number of samples.
+			long double extrapolation = 100;
+
+		};
+
+
+		/// @class early_options
+		/// Options for the early termination of estimators.
+		struct early_options {
+
+			/// Stop as soon as an error exceeds the tolerance or is NaN,
+			/// as the test is then known to fail when the fail function
+			/// is on the maximum error (e.g. fail::fail_on_max_err).
+			bool failFast = false;
+
+			/// Accept a Monte Carlo estimate before all iterations, once
+			/// the upper confidence bound of the given error field
+			/// ("meanErr" or "rmsErr") is within tolerance (disabled if empty).
+			std::string accept = "";
+
+			/// Confidence level of early acceptance over the whole estimate,
+			/// which is divided between the checks of the criterion.
+			long double confidence = 0.999;
+
+			/// Minimum number of iterations before early acceptance.
+			unsigned int minIterations = 1000;
+
+		};
+
+
 		/// Distance function between two elements.
 		template<typename Type>
 		using DistanceFunction = std::function<long double(Type, Type)>;
@@ -106,6 +164,14 @@ namespace chebyshev {
 				return (r.maxErr > r.tolerance) || (r.maxErr != r.maxErr);
 			};
 
+			/// Options for the extreme value estimate of the maximum
+			/// error by Monte Carlo estimators (disabled by default).
+			tail_options tail {};
+
+			/// Options for the early termination of estimators
+			/// (disabled by default).
+			early_options early {};
+
 			/// Whether to show the test result or not.
 			bool quiet = false;
 
@@ -158,6 +224,241 @@ namespace chebyshev {
 		using Estimator = typename estimate_options<R, Args...>::Estimator_t;
 
 
+		/// @class sweep_options
+		/// A structure holding the options for sweep estimation
+		/// of a real function over multiple floating point types.
+		struct sweep_options {
+
+			/// The domain of estimation.
+			interval domain {};
+
+			/// The tolerance on the error in ULPs of each type.
+			long double tolerance = CHEBYSHEV_PREC_ULP_TOLERANCE;
+
+			/// Number of quadrature subintervals
+			/// (the reference is evaluated iterations + 1 times).
+			unsigned int iterations = CHEBYSHEV_PREC_ITER;
+
+			/// The function to determine whether the test failed
+			/// for each type (defaults to fail::fail_on_max_ulp).
+			FailFunction fail = [](const estimate_result& r) {
+
+				const auto it = r.additionalFields.find("maxUlp");
+
+				if(it == r.additionalFields.end())
+					return true;
+
+				return (it->second > r.tolerance) || (it->second != it->second);
+			};
+
+			/// The rounding modes to evaluate the approximation in
+			/// (e.g. sweep::rounding_modes() for all four modes).
+			/// If empty, only the current rounding mode is used.
+			std::vector<int> roundingModes {};
+
+			/// Whether to show the test result or not.
+			bool quiet = false;
+
+
+			/// Construct sweep options with all default values.
+			/// @note The domain must be set to correctly
+			/// use the options for test cases.
+			sweep_options() {}
+
+
+			/// Construct sweep options from the domain of estimation,
+			/// the tolerance in ULPs and an optional quiet flag.
+			sweep_options(
+				interval omega,
+				long double tolerance = CHEBYSHEV_PREC_ULP_TOLERANCE,
+				bool quiet = false)
+			: domain(omega), tolerance(tolerance), quiet(quiet) {}
+		};
+
+
+		/// @class shadow_options
+		/// A structure holding the options for shadow sampling
+		/// of a function in production code.
+		struct shadow_options {
+
+			/// One call out of period is sampled, counting
+			/// the calls of each thread separately.
+			unsigned int period = CHEBYSHEV_PREC_SHADOW_PERIOD;
+
+			/// Capacity of the queue of samples of each thread
+			/// (rounded up to a power of two). Samples are dropped
+			/// when the queue is full.
+			unsigned int queueSize = 4096;
+
+			/// The tolerance on the max absolute error.
+			long double tolerance = CHEBYSHEV_PREC_TOLERANCE;
+
+			/// Interval between periodic exports in milliseconds
+			/// (no periodic export is made if zero).
+			unsigned int exportInterval = 0;
+
+			/// The files to export the statistics to. When exporting
+			/// periodically, the files are overwritten on each export.
+			std::vector<std::string> exportFiles {};
+
+			/// The columns to export.
+			std::vector<std::string> columns = {
+				"name", "meanErr", "rmsErr", "maxErr", "maxUlp",
+				"worstInput", "samples", "failed"
+			};
+
+
+			/// Construct shadow options with all default values.
+			shadow_options() {}
+
+
+			/// Construct shadow options from the sampling period
+			/// and the tolerance on the max absolute error.
+			shadow_options(
+				unsigned int period,
+				long double tolerance = CHEBYSHEV_PREC_TOLERANCE)
+			: period(period), tolerance(tolerance) {}
+		};
+
+
+		/// @class bound_options
+		/// A structure holding the options for branch-and-bound
+		/// estimation with interval arithmetic.
+		struct bound_options {
+
+			/// The domain of estimation.
+			std::vector<interval> domain {};
+
+			/// The tolerance on the max absolute error.
+			long double tolerance = CHEBYSHEV_PREC_TOLERANCE;
+
+			/// Number of function evaluations to use
+			/// if no subdomain is proven within tolerance.
+			unsigned int iterations = CHEBYSHEV_PREC_ITER;
+
+			/// Maximum number of bisections of a subdomain.
+			unsigned int maxDepth = 16;
+
+			/// Maximum number of subdomains.
+			unsigned int maxSubdomains = 4096;
+
+			/// The function to determine whether the test failed
+			/// (defaults to fail::fail_on_max_err).
+			FailFunction fail = [](const estimate_result& r) {
+				return (r.maxErr > r.tolerance) || (r.maxErr != r.maxErr);
+			};
+
+			/// Whether to show the test result or not.
+			bool quiet = false;
+
+
+			/// Construct bound options with all default values.
+			/// @note The domain must be set to correctly
+			/// use the options for test cases.
+			bound_options() {}
+
+
+			/// Construct bound options from a one-dimensional domain,
+			/// the tolerance and an optional quiet flag.
+			bound_options(
+				interval omega,
+				long double tolerance = CHEBYSHEV_PREC_TOLERANCE,
+				bool quiet = false)
+			: domain({omega}), tolerance(tolerance), quiet(quiet) {}
+
+
+			/// Construct bound options from a multidimensional domain,
+			/// the tolerance and an optional quiet flag.
+			bound_options(
+				std::vector<interval> omega,
+				long double tolerance = CHEBYSHEV_PREC_TOLERANCE,
+				bool quiet = false)
+			: domain(omega), tolerance(tolerance), quiet(quiet) {}
+		};
+
+
+		/// @class residual_options
+		/// A structure holding the options for residual
+		/// testing of linear algebra kernels.
+		struct residual_options {
+
+			/// The tolerance on the relative residual (if zero,
+			/// the tolerance is epsilonFactor times the dimension
+			/// of the problem times the machine epsilon of the
+			/// element type).
+			long double tolerance = 0;
+
+			/// Multiple of the dimension times the machine epsilon
+			/// to use as tolerance, if no tolerance is given.
+			long double epsilonFactor = 10;
+
+			/// The number of threads to use
+			/// (defaults to the number of hardware threads).
+			unsigned int threads = 0;
+
+			/// The size of the blocks of rows and columns
+			/// of the cache-blocked kernels.
+			unsigned int blockSize = 64;
+
+			/// Whether to show the test result or not.
+			bool quiet = false;
+
+
+			/// Construct residual options with all default values.
+			residual_options() {}
+
+
+			/// Construct residual options from the tolerance
+			/// on the relative residual and an optional quiet flag.
+			residual_options(long double tolerance, bool quiet = false)
+			: tolerance(tolerance), quiet(quiet) {}
+		};
+
+
+		/// @class property_suite
+		/// A structure selecting the properties of an endofunction
+		/// to check together with prec::property::suite.
+		/// Properties are disabled by default.
+		template<typename Type = double>
+		struct property_suite {
+
+			/// Check that the function is equivalent to the identity.
+			bool identity = false;
+
+			/// Check that the function is an involution, f(f(x)) = x.
+			bool involution = false;
+
+			/// Check that the function is idempotent, f(f(x)) = f(x).
+			bool idempotence = false;
+
+			/// Check that the function is homogeneous, f(x) = 0.
+			bool homogeneous = false;
+
+			/// Check that the function is even, f(-x) = f(x).
+			bool even = false;
+
+			/// Check that the function is odd, f(-x) = -f(x).
+			bool odd = false;
+
+			/// Check that the function is non-decreasing over the domain.
+			bool increasing = false;
+
+			/// Check that the function is non-increasing over the domain.
+			bool decreasing = false;
+
+			/// Check that the function is periodic with the given
+			/// period, f(x + T) = f(x), if the period is not zero.
+			Type period = Type(0.0);
+
+			/// Check that the given function is the inverse
+			/// of the function, g(f(x)) = x, if it is set.
+			std::function<Type(Type)> inverse {};
+
+			/// The zero element used to check homogeneity.
+			Type zeroElement = Type(0.0);
+		};
+
+
 		/// @class equation_result
 		/// A structure holding the result of an evaluation.
 		struct equation_result {
@@ -181,6 +482,9 @@ namespace chebyshev {
 			/// Tolerance on the absolute difference.
 			long double tolerance = 0;
 
+			/// Wall time spent on the test case, in milliseconds.
+			long double wallTime = 0;
+
 			/// Whether the test failed.
 			bool failed = true;
 
@@ -0,0 +1,752 @@
+///
+/// @file residual.h Residual testing of linear algebra kernels.
+///
+
+#ifndef CHEBYSHEV_RESIDUAL_H
+#define CHEBYSHEV_RESIDUAL_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../core/common.h"
+#include "../core/random.h"
+#include "./prec_structures.h"
+
+
+namespace chebyshev {
+namespace prec {
+
+
+	/// @namespace chebyshev::prec::residual Residual testing
+	///
+	/// The results of linear algebra kernels (such as solvers,
+	/// products and factorizations) are rarely known exactly,
+	/// but their accuracy may be measured by their residuals,
+	/// e.g. the normwise backward error of the solution of a linear
+	/// system or the loss of orthogonality of a matrix. Residuals
+	/// are accumulated in extended precision by cache-blocked,
+	/// multithreaded loops and compared to relative tolerances
+	/// which scale with the dimension of the problem.
+	namespace residual {
+
+
+		/// @class dense_matrix
+		/// A dense matrix stored in row-major order,
+		/// where the element (i, j) has index i * cols + j.
+		template<typename Type = double>
+		struct dense_matrix {
+
+			/// The number of rows.
+			size_t rows = 0;
+
+			/// The number of columns.
+			size_t cols = 0;
+
+			/// The elements of the matrix.
+			std::vector<Type> data {};
+
+
+			/// Construct an empty matrix.
+			dense_matrix() {}
+
+
+			/// Construct a matrix with all elements
+			/// equal to the given value.
+			dense_matrix(size_t rows, size_t cols, Type value = Type(0))
+			: rows(rows), cols(cols), data(rows * cols, value) {}
+
+
+			/// Construct a matrix from its elements in row-major order
+			/// (e.g. as generated by random::matrix).
+			dense_matrix(size_t rows, size_t cols, const std::vector<Type>& data)
+			: rows(rows), cols(cols), data(data) {
+
+				if(data.size() != rows * cols)
+					throw std::runtime_error(
+						"The number of elements does not match the size of the matrix in prec::residual::dense_matrix");
+			}
+
+
+			/// Access the element (i, j).
+			inline Type& operator()(size_t i, size_t j) {
+				return data[i * cols + j];
+			}
+
+
+			/// Access the element (i, j).
+			inline const Type& operator()(size_t i, size_t j) const {
+				return data[i * cols + j];
+			}
+
+
+			/// The identity matrix of the given size.
+			inline static dense_matrix identity(size_t n) {
+
+				dense_matrix I (n, n);
+
+				for (size_t i = 0; i < n; ++i)
+					I(i, i) = Type(1);
+
+				return I;
+			}
+		};
+
+
+		/// @class sparse_matrix
+		/// A sparse matrix stored in compressed sparse row (CSR) format,
+		/// where the non-zero elements of the i-th row are stored in
+		/// the range [rowIndex[i], rowIndex[i + 1]) of the columns
+		/// and values.
+		template<typename Type = double>
+		struct sparse_matrix {
+
+			/// The number of rows.
+			size_t rows = 0;
+
+			/// The number of columns.
+			size_t cols = 0;
+
+			/// The index of the first element of each row,
+			/// with one additional element for the end of the last row.
+			std::vector<size_t> rowIndex {0};
+
+			/// The column of each non-zero element.
+			std::vector<size_t> columns {};
+
+			/// The value of each non-zero element.
+			std::vector<Type> values {};
+
+
+			/// Construct an empty matrix.
+			sparse_matrix() {}
+
+
+			/// Construct a matrix with no non-zero elements.
+			sparse_matrix(size_t rows, size_t cols)
+			: rows(rows), cols(cols), rowIndex(rows + 1, 0) {}
+
+
+			/// Construct a sparse matrix from the
+			/// non-zero elements of a dense matrix.
+			sparse_matrix(const dense_matrix<Type>& A)
+			: rows(A.rows), cols(A.cols), rowIndex(A.rows + 1, 0) {
+
+				for (size_t i = 0; i < rows; ++i) {
+
+					for (size_t j = 0; j < cols; ++j) {
+
+						if(A(i, j) != Type(0)) {
+							columns.push_back(j);
+							values.push_back(A(i, j));
+						}
+					}
+
+					rowIndex[i + 1] = values.size();
+				}
+			}
+
+
+			/// The number of non-zero elements.
+			inline size_t nonzeros() const {
+				return values.size();
+			}
+		};
+
+
+		/// Run a function over blocks of the range [0, count)
+		/// on multiple threads, with dynamic scheduling.
+		/// The function is called with the index of the block
+		/// and the extremes of its range.
+		///
+		/// @param count The size of the range
+		/// @param block The size of each block
+		/// @param threads The number of threads to use
+		/// (defaults to the number of hardware threads)
+		template<typename Function>
+		inline void parallel_for(size_t count, size_t block, unsigned int threads, Function f) {
+
+			block = std::max<size_t>(block, 1);
+			const size_t blocks = (count + block - 1) / block;
+
+			unsigned int workers = threads ? threads : std::thread::hardware_concurrency();
+			workers = workers ? workers : 1;
+
+			std::atomic<size_t> next {0};
+
+			// Each block draws from its own engine, seeded by the
+			// calling thread, whatever the thread which runs it
+			const std::vector<uint64_t> seeds = random::seeds(blocks);
+			const random::xoshiro256 callerEngine = random::engine;
+
+			auto work = [&]() {
+				for (size_t b = next++; b < blocks; b = next++) {
+					random::engine.seed(seeds[b]);
+					f(b, b * block, std::min(count, (b + 1) * block));
+				}
+			};
+
+			std::vector<std::thread> pool;
+			const size_t poolSize = std::min<size_t>(workers, blocks);
+
+			for (size_t t = 1; t < poolSize; ++t)
+				pool.emplace_back(work);
+
+			work();
+			random::engine = callerEngine;
+
+			for (std::thread& t : pool)
+				t.join();
+		}
+
+
+		/// The default tolerance on a relative residual,
+		/// scaling with the dimension of the problem.
+		///
+		/// @param opt The options of the residual test
+		/// @param n The dimension of the problem
+		template<typename Type>
+		inline long double tolerance(const residual_options& opt, size_t n) {
+
+			if(opt.tolerance > 0)
+				return opt.tolerance;
+
+			return opt.epsilonFactor * std::max<size_t>(n, 1)
+				* (long double) std::numeric_limits<Type>::epsilon();
+		}
+
+
+		/// Infinity norm of a vector.
+		template<typename Type>
+		inline long double norm_inf(const std::vector<Type>& x) {
+
+			long double res = 0;
+
+			for (const Type& xi : x)
+				res = std::max<long double>(res, std::abs((long double) xi));
+
+			return res;
+		}
+
+
+		/// Infinity norm of a dense matrix (maximum absolute row sum).
+		template<typename Type>
+		inline long double norm_inf(const dense_matrix<Type>& A) {
+
+			long double res = 0;
+
+			for (size_t i = 0; i < A.rows; ++i) {
+
+				long double sum = 0;
+				for (size_t j = 0; j < A.cols; ++j)
+					sum += std::abs((long double) A(i, j));
+
+				res = std::max(res, sum);
+			}
+
+			return res;
+		}
+
+
+		/// Infinity norm of a sparse matrix (maximum absolute row sum).
+		template<typename Type>
+		inline long double norm_inf(const sparse_matrix<Type>& A) {
+
+			long double res = 0;
+
+			for (size_t i = 0; i < A.rows; ++i) {
+
+				long double sum = 0;
+				for (size_t k = A.rowIndex[i]; k < A.rowIndex[i + 1]; ++k)
+					sum += std::abs((long double) A.values[k]);
+
+				res = std::max(res, sum);
+			}
+
+			return res;
+		}
+
+
+		/// Frobenius norm of a dense matrix.
+		template<typename Type>
+		inline long double norm_frobenius(const dense_matrix<Type>& A) {
+
+			long double sum = 0;
+
+			for (const Type& a : A.data)
+				sum += (long double) a * (long double) a;
+
+			return std::sqrt(sum);
+		}
+
+
+		/// Transpose a dense matrix, by square blocks.
+		template<typename Type>
+		inline dense_matrix<Type> transpose(const dense_matrix<Type>& A, size_t block = 64) {
+
+			dense_matrix<Type> T (A.cols, A.rows);
+			block = std::max<size_t>(block, 1);
+
+			for (size_t ib = 0; ib < A.rows; ib += block)
+				for (size_t jb = 0; jb < A.cols; jb += block)
+					for (size_t i = ib; i < std::min(A.rows, ib + block); ++i)
+						for (size_t j = jb; j < std::min(A.cols, jb + block); ++j)
+							T(j, i) = A(i, j);
+
+			return T;
+		}
+
+
+		/// Compute the residual b - Ax of a dense linear system
+		/// in extended precision, in parallel over blocks of rows.
+		///
+		/// @param A The matrix of the system
+		/// @param x The solution to test
+		/// @param b The right-hand side
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline std::vector<long double> residual_vector(
+			const dense_matrix<Type>& A,
+			const std::vector<Type>& x,
+			const std::vector<Type>& b,
+			const residual_options& opt = residual_options()) {
+
+			if(x.size() != A.cols || b.size() != A.rows)
+				throw std::runtime_error(
+					"Size mismatch between the matrix and the vectors in prec::residual::residual_vector");
+
+			std::vector<long double> r (A.rows);
+
+			parallel_for(A.rows, opt.blockSize, opt.threads,
+				[&](size_t, size_t begin, size_t end) {
+
+				for (size_t i = begin; i < end; ++i) {
+
+					const Type* row = &A.data[i * A.cols];
+					long double sum = b[i];
+
+					for (size_t j = 0; j < A.cols; ++j)
+						sum -= (long double) row[j] * (long double) x[j];
+
+					r[i] = sum;
+				}
+			});
+
+			return r;
+		}
+
+
+		/// Compute the residual b - Ax of a sparse linear system
+		/// in extended precision, in parallel over blocks of rows.
+		///
+		/// @param A The matrix of the system
+		/// @param x The solution to test
+		/// @param b The right-hand side
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline std::vector<long double> residual_vector(
+			const sparse_matrix<Type>& A,
+			const std::vector<Type>& x,
+			const std::vector<Type>& b,
+			const residual_options& opt = residual_options()) {
+
+			if(x.size() != A.cols || b.size() != A.rows)
+				throw std::runtime_error(
+					"Size mismatch between the matrix and the vectors in prec::residual::residual_vector");
+
+			std::vector<long double> r (A.rows);
+
+			// Rows are distributed in larger blocks, as they are short
+			parallel_for(A.rows, opt.blockSize * 64, opt.threads,
+				[&](size_t, size_t begin, size_t end) {
+
+				for (size_t i = begin; i < end; ++i) {
+
+					long double sum = b[i];
+
+					for (size_t k = A.rowIndex[i]; k < A.rowIndex[i + 1]; ++k)
+						sum -= (long double) A.values[k] * (long double) x[A.columns[k]];
+
+					r[i] = sum;
+				}
+			});
+
+			return r;
+		}
+
+
+		/// Compute the product Ax of a matrix and a vector, rounded to
+		/// the element type, in parallel over blocks of rows
+		/// (e.g. to construct the right-hand side of a linear system
+		/// with a known solution).
+		///
+		/// @param A The dense or sparse matrix
+		/// @param x The vector to multiply
+		/// @param opt The options of the residual test
+		template<typename Matrix, typename Type>
+		inline std::vector<Type> multiply(
+			const Matrix& A,
+			const std::vector<Type>& x,
+			const residual_options& opt = residual_options()) {
+
+			const std::vector<long double> r =
+				residual_vector(A, x, std::vector<Type>(A.rows, Type(0)), opt);
+
+			std::vector<Type> y (A.rows);
+			for (size_t i = 0; i < A.rows; ++i)
+				y[i] = static_cast<Type>(-r[i]);
+
+			return y;
+		}
+
+
+		/// Compute the squared Frobenius norm of C - AB in extended
+		/// precision, without forming the product, by square tiles
+		/// of the result, distributed between threads by blocks of
+		/// rows, accumulating over blocks of the inner dimension.
+		///
+		/// @param A The left factor
+		/// @param B The right factor
+		/// @param C The expected product
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline long double product_difference(
+			const dense_matrix<Type>& A,
+			const dense_matrix<Type>& B,
+			const dense_matrix<Type>& C,
+			const residual_options& opt = residual_options()) {
+
+			if(A.cols != B.rows || A.rows != C.rows || B.cols != C.cols)
+				throw std::runtime_error(
+					"Size mismatch between the matrices in prec::residual::product_difference");
+
+			const size_t block = std::max<unsigned int>(opt.blockSize, 1);
+			const size_t rowBlocks = (A.rows + block - 1) / block;
+			std::vector<long double> partial (rowBlocks, 0);
+
+			parallel_for(A.rows, block, opt.threads,
+				[&](size_t index, size_t ib, size_t iend) {
+
+				std::vector<long double> tile (block * block);
+				long double sum = 0;
+
+				for (size_t jb = 0; jb < B.cols; jb += block) {
+
+					const size_t jend = std::min(B.cols, jb + block);
+					const size_t width = jend - jb;
+					std::fill(tile.begin(), tile.end(), 0);
+
+					for (size_t kb = 0; kb < A.cols; kb += block) {
+
+						const size_t kend = std::min(A.cols, kb + block);
+
+						for (size_t i = ib; i < iend; ++i) {
+
+							long double* t = &tile[(i - ib) * block];
+
+							for (size_t k = kb; k < kend; ++k) {
+
+								const long double a = A(i, k);
+								const Type* row = &B.data[k * B.cols + jb];
+
+								for (size_t j = 0; j < width; ++j)
+									t[j] += a * (long double) row[j];
+							}
+						}
+					}
+
+					for (size_t i = ib; i < iend; ++i) {
+						for (size_t j = jb; j < jend; ++j) {
+							const long double d = (long double) C(i, j) - tile[(i - ib) * block + (j - jb)];
+							sum += d * d;
+						}
+					}
+				}
+
+				partial[index] = sum;
+			});
+
+			long double res = 0;
+			for (long double p : partial)
+				res += p;
+
+			return res;
+		}
+
+
+		/// Compute the relative residual of the solution of a
+		/// linear system Ax = b, as the normwise backward error
+		/// |b - Ax| / (|A| |x| + |b|) in the infinity norm.
+		/// The absolute residual |b - Ax| and the backward error are
+		/// stored in the "residual" and "backwardError" fields.
+		///
+		/// @param A The dense or sparse matrix of the system
+		/// @param x The solution to test
+		/// @param b The right-hand side
+		/// @param opt The options of the residual test
+		template<typename Matrix, typename Type>
+		inline equation_result solve(
+			const Matrix& A,
+			const std::vector<Type>& x,
+			const std::vector<Type>& b,
+			const residual_options& opt = residual_options()) {
+
+			const long double r = norm_inf(residual_vector(A, x, b, opt));
+			const long double scale = norm_inf(A) * norm_inf(x) + norm_inf(b);
+
+			equation_result res {};
+			res.difference = (scale > 0) ? (r / scale) : r;
+			res.tolerance = tolerance<Type>(opt, A.cols);
+			res.failed = !(res.difference <= res.tolerance);
+			res.quiet = opt.quiet;
+			res.additionalFields["residual"] = r;
+			res.additionalFields["backwardError"] = res.difference;
+
+			return res;
+		}
+
+
+		/// Compute the relative residual |C - AB| / (|A| |B|) of the
+		/// product of two dense matrices, in the Frobenius norm.
+		/// The absolute residual is stored in the "residual" field.
+		///
+		/// @param A The left factor
+		/// @param B The right factor
+		/// @param C The product to test
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline equation_result product(
+			const dense_matrix<Type>& A,
+			const dense_matrix<Type>& B,
+			const dense_matrix<Type>& C,
+			const residual_options& opt = residual_options()) {
+
+			const long double r = std::sqrt(product_difference(A, B, C, opt));
+			const long double scale = norm_frobenius(A) * norm_frobenius(B);
+
+			equation_result res {};
+			res.difference = (scale > 0) ? (r / scale) : r;
+			res.tolerance = tolerance<Type>(opt, A.cols);
+			res.failed = !(res.difference <= res.tolerance);
+			res.quiet = opt.quiet;
+			res.additionalFields["residual"] = r;
+
+			return res;
+		}
+
+
+		/// Compute the relative residual |A - LU| / |A| of a
+		/// factorization of a dense matrix into two factors
+		/// (e.g. LU, QR or Cholesky), in the Frobenius norm.
+		/// Permutations must be applied to A beforehand.
+		/// The absolute residual is stored in the "residual" field.
+		///
+		/// @param A The factorized matrix
+		/// @param L The left factor
+		/// @param U The right factor
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline equation_result factorization(
+			const dense_matrix<Type>& A,
+			const dense_matrix<Type>& L,
+			const dense_matrix<Type>& U,
+			const residual_options& opt = residual_options()) {
+
+			const long double r = std::sqrt(product_difference(L, U, A, opt));
+			const long double scale = norm_frobenius(A);
+
+			equation_result res {};
+			res.difference = (scale > 0) ? (r / scale) : r;
+			res.tolerance = tolerance<Type>(opt, L.cols);
+			res.failed = !(res.difference <= res.tolerance);
+			res.quiet = opt.quiet;
+			res.additionalFields["residual"] = r;
+
+			return res;
+		}
+
+
+		/// Compute the loss of orthogonality |Q^T Q - I| of the
+		/// columns of a dense matrix, in the Frobenius norm,
+		/// also stored in the "orthogonality" field.
+		///
+		/// @param Q The matrix with orthonormal columns to test
+		/// @param opt The options of the residual test
+		template<typename Type>
+		inline equation_result orthogonality(
+			const dense_matrix<Type>& Q,
+			const residual_options& opt = residual_options()) {
+
+			const long double r = std::sqrt(product_difference(
+				transpose(Q, opt.blockSize), Q, dense_matrix<Type>::identity(Q.cols), opt));
+
+			equation_result res {};
+			res.difference = r;
+			res.tolerance = tolerance<Type>(opt, Q.rows);
+			res.failed = !(res.difference <= res.tolerance);
+			res.quiet = opt.quiet;
+			res.additionalFields["orthogonality"] = r;
+
+			return res;
+		}
+
+
+		/// Generate a dense matrix with elements
+		/// uniformly distributed over [a, b).
+		///
+		/// @param rows The number of rows
+		/// @param cols The number of columns
+		/// @param a The lower extreme of the interval
+		/// @param b The upper extreme of the interval
+		template<typename Type = double>
+		inline dense_matrix<Type> random_matrix(
+			size_t rows, size_t cols, long double a = -1, long double b = 1) {
+
+			return dense_matrix<Type>(rows, cols, random::matrix<Type>(rows, cols, a, b));
+		}
+
+
+		/// Generate a random square matrix with the given condition
+		/// number in the 2-norm, as H1 S H2, where S is diagonal with
+		/// singular values geometrically distributed between 1 and
+		/// 1 / cond and H1, H2 are random Householder reflections.
+		/// The matrix is generated in O(n^2) operations.
+		///
+		/// @param n The size of the matrix
+		/// @param cond The condition number of the matrix
+		template<typename Type = double>
+		inline dense_matrix<Type> conditioned(size_t n, long double cond) {
+
+			// Random unit vectors of the reflections
+			auto unit = [n]() {
+
+				std::vector<long double> u = random::array<long double>(n, -1, 1);
+
+				long double norm = 0;
+				for (long double ui : u)
+					norm += ui * ui;
+
+				norm = std::sqrt(norm);
+
+				for (long double& ui : u)
+					ui = (norm > 0) ? (ui / norm) : 0;
+
+				return u;
+			};
+
+			const std::vector<long double> u = unit();
+			const std::vector<long double> v = unit();
+
+			std::vector<long double> s (n, 1);
+			for (size_t i = 1; i < n; ++i)
+				s[i] = std::pow(cond, -(long double) i / (n - 1));
+
+			// w = (H1 S) v
+			long double usv = 0;
+			for (size_t j = 0; j < n; ++j)
+				usv += u[j] * s[j] * v[j];
+
+			std::vector<long double> w (n);
+			for (size_t i = 0; i < n; ++i)
+				w[i] = s[i] * v[i] - 2 * u[i] * usv;
+
+			// A = H1 S - 2 w v^T
+			dense_matrix<Type> A (n, n);
+
+			for (size_t i = 0; i < n; ++i) {
+				for (size_t j = 0; j < n; ++j) {
+					A(i, j) = static_cast<Type>(
+						(i == j ? s[j] : 0) - 2 * u[i] * u[j] * s[j] - 2 * w[i] * v[j]);
+				}
+			}
+
+			return A;
+		}
+
+
+		/// Generate a random well-conditioned square matrix.
+		///
+		/// @param n The size of the matrix
+		/// @param cond The condition number of the matrix
+		template<typename Type = double>
+		inline dense_matrix<Type> well_conditioned(size_t n, long double cond = 10) {
+			return conditioned<Type>(n, cond);
+		}
+
+
+		/// Generate a random ill-conditioned square matrix.
+		///
+		/// @param n The size of the matrix
+		/// @param cond The condition number of the matrix
+		template<typename Type = double>
+		inline dense_matrix<Type> ill_conditioned(size_t n, long double cond = 1E+12) {
+			return conditioned<Type>(n, cond);
+		}
+
+
+		/// Generate many random square matrices with
+		/// the given condition number in the 2-norm.
+		///
+		/// @param count The number of matrices
+		/// @param n The size of the matrices
+		/// @param cond The condition number of the matrices
+		template<typename Type = double>
+		inline std::vector<dense_matrix<Type>> conditioned_matrices(
+			size_t count, size_t n, long double cond) {
+
+			std::vector<dense_matrix<Type>> res;
+			res.reserve(count);
+
+			for (size_t i = 0; i < count; ++i)
+				res.push_back(conditioned<Type>(n, cond));
+
+			return res;
+		}
+
+
+		/// Generate a random sparse square matrix with about the given
+		/// number of non-zero elements per row, uniformly distributed
+		/// over [-1, 1), and a strictly dominant diagonal, so that
+		/// the matrix is well-conditioned.
+		///
+		/// @param n The size of the matrix
+		/// @param nonzeros The number of non-zero elements per row
+		template<typename Type = double>
+		inline sparse_matrix<Type> sparse(size_t n, size_t nonzeros) {
+
+			sparse_matrix<Type> A (n, n);
+			std::vector<size_t> cols;
+
+			for (size_t i = 0; i < n; ++i) {
+
+				cols.clear();
+				cols.push_back(i);
+
+				for (size_t k = 1; k < nonzeros; ++k)
+					cols.push_back(random::bounded(n));
+
+				std::sort(cols.begin(), cols.end());
+				cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+
+				for (size_t j : cols) {
+					A.columns.push_back(j);
+					A.values.push_back((j == i)
+						? static_cast<Type>(cols.size() + 1)
+						: static_cast<Type>(2 * random::real() - 1));
+				}
+
+				A.rowIndex[i + 1] = A.values.size();
+			}
+
+			return A;
+		}
+
+	}
+
+}}
+
+#endif
@@ -0,0 +1,527 @@
+///
+/// @file shadow.h Online shadow precision sampling.
+///
+
+#ifndef CHEBYSHEV_SHADOW_H
+#define CHEBYSHEV_SHADOW_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "../prec.h"
+#include "./sweep.h"
+#include "../benchmark/timer.h"
+
+
+namespace chebyshev {
+namespace prec {
+
+
+	/// @namespace chebyshev::prec::shadow Shadow precision sampling
+	///
+	/// A shadow sampler monitors the precision of a function in
+	/// production code. One call out of a configurable period is
+	/// sampled: its input and result are pushed to a lock-free queue
+	/// of the calling thread, and a background thread evaluates the
+	/// reference function on the same input, accumulating error
+	/// statistics which may be exported through the output formats.
+	/// The fast path of a call is one increment of a thread local
+	/// counter and one branch.
+	namespace shadow {
+
+
+		/// Thread local call counters of all shadow samplers, by id.
+		inline unsigned int* counters() {
+
+			thread_local unsigned int c[CHEBYSHEV_PREC_SHADOW_MAX] {};
+			return c;
+		}
+
+
+		/// Thread local states of all shadow samplers, by id.
+		inline void** local_states() {
+
+			thread_local void* s[CHEBYSHEV_PREC_SHADOW_MAX] {};
+			return s;
+		}
+
+
+		/// Allocate a unique id for a shadow sampler.
+		/// Ids are never reused, so that thread local
+		/// states never refer to a destroyed sampler.
+		inline unsigned int allocate_id() {
+
+			static std::atomic<unsigned int> next {0};
+			const unsigned int id = next++;
+
+			if(id >= CHEBYSHEV_PREC_SHADOW_MAX)
+				throw std::runtime_error(
+					"Too many shadow samplers in prec::shadow (see CHEBYSHEV_PREC_SHADOW_MAX)");
+
+			return id;
+		}
+
+
+		/// Round a positive number up to a power of two.
+		inline unsigned int next_power_of_two(unsigned int n) {
+
+			unsigned int p = 1;
+			while(p < n)
+				p <<= 1;
+
+			return p;
+		}
+
+
+		/// @class ring
+		/// A lock-free single producer, single consumer queue
+		/// of fixed capacity (a power of two).
+		template<typename Type>
+		class ring {
+			private:
+				std::vector<Type> buffer;
+				size_t mask;
+				std::atomic<size_t> head {0};
+				std::atomic<size_t> tail {0};
+
+			public:
+
+				/// Construct a queue with the given capacity.
+				ring(unsigned int capacity)
+				: buffer(next_power_of_two(capacity)), mask(buffer.size() - 1) {}
+
+
+				/// Push an element, returning false if the queue is full.
+				/// Only called by the producer thread.
+				inline bool push(const Type& value) {
+
+					const size_t t = tail.load(std::memory_order_relaxed);
+
+					if(t - head.load(std::memory_order_acquire) == buffer.size())
+						return false;
+
+					buffer[t & mask] = value;
+					tail.store(t + 1, std::memory_order_release);
+					return true;
+				}
+
+
+				/// Pop an element, returning false if the queue is empty.
+				/// Only called by the consumer thread.
+				inline bool pop(Type& value) {
+
+					const size_t h = head.load(std::memory_order_relaxed);
+
+					if(h == tail.load(std::memory_order_acquire))
+						return false;
+
+					value = buffer[h & mask];
+					head.store(h + 1, std::memory_order_release);
+					return true;
+				}
+		};
+
+
+		/// @class accumulator
+		/// Error statistics over the samples of a thread.
+		/// Only the background thread writes to an accumulator,
+		/// so no synchronization is needed.
+		struct accumulator {
+
+			/// Number of samples.
+			uint64_t samples = 0;
+
+			/// Sum of absolute errors.
+			long double sum = 0;
+
+			/// Sum of squared errors.
+			long double sumSqr = 0;
+
+			/// Sum of absolute expected values.
+			long double sumAbs = 0;
+
+			/// Maximum absolute error (NaN if any error was NaN).
+			long double max = 0;
+
+			/// Input of the maximum absolute error.
+			long double worstInput = get_nan<long double>();
+
+			/// Sum of errors in ULPs.
+			long double sumUlp = 0;
+
+			/// Maximum error in ULPs.
+			long double maxUlp = 0;
+
+
+			/// Add the error of a sample.
+			inline void add(long double x, long double diff, long double expected, long double ulps) {
+
+				samples++;
+				sum += diff;
+				sumSqr += diff * diff;
+				sumAbs += std::abs(expected);
+				sumUlp += ulps;
+
+				if(diff > max || diff != diff) {
+
+					if(max == max)
+						worstInput = x;
+
+					max = (max != max) ? max : diff;
+				}
+
+				if(ulps > maxUlp || ulps != ulps)
+					maxUlp = (maxUlp != maxUlp) ? maxUlp : ulps;
+			}
+
+
+			/// Merge the statistics of another accumulator.
+			inline void merge(const accumulator& other) {
+
+				samples += other.samples;
+				sum += other.sum;
+				sumSqr += other.sumSqr;
+				sumAbs += other.sumAbs;
+				sumUlp += other.sumUlp;
+
+				if(other.max > max || other.max != other.max) {
+
+					if(max == max)
+						worstInput = other.worstInput;
+
+					max = (max != max) ? max : other.max;
+				}
+
+				if(other.maxUlp > maxUlp || other.maxUlp != other.maxUlp)
+					maxUlp = (maxUlp != maxUlp) ? maxUlp : other.maxUlp;
+			}
+		};
+
+	}
+
+
+	/// @class shadow_sampler
+	/// A sampler which monitors the precision of an approximation
+	/// against a reference function during normal execution.
+	/// The approximation is either called through the sampler,
+	/// or its results are passed to observe() together with the input.
+	///
+	/// The collected statistics are returned by result() as an
+	/// estimate_result, with the mean, RMS and maximum errors over the
+	/// samples, the "maxUlp", "meanUlp", "worstInput", "samples" and
+	/// "dropped" additional fields. The maximum error is tested
+	/// against the tolerance of the options.
+	template<typename R, typename Arg = R>
+	class shadow_sampler {
+		private:
+
+			/// A sampled call
+			struct sample {
+				Arg x;
+				R y;
+			};
+
+			/// The samples and statistics of a thread
+			struct thread_state {
+
+				shadow::ring<sample> queue;
+				shadow::accumulator acc;
+				std::atomic<uint64_t> dropped {0};
+
+				thread_state(unsigned int capacity) : queue(capacity) {}
+			};
+
+			std::string name;
+			std::function<R(Arg)> funcApprox;
+			std::function<R(Arg)> funcExpected;
+			shadow_options opt;
+
+			unsigned int id;
+			unsigned int period;
+
+			/// States of the threads which sampled calls
+			std::vector<std::unique_ptr<thread_state>> states;
+			std::mutex statesMutex;
+
+			/// Latest statistics, updated by the background thread
+			estimate_result snapshot;
+			mutable std::mutex snapshotMutex;
+
+			std::atomic<bool> stop {false};
+			std::atomic<uint64_t> passes {0};
+			std::thread worker;
+
+
+			/// Get the state of the current thread,
+			/// creating it on the first sample.
+			inline thread_state& local_state() {
+
+				void*& state = shadow::local_states()[id];
+
+				if(!state) {
+
+					std::lock_guard<std::mutex> lock (statesMutex);
+					states.emplace_back(new thread_state(opt.queueSize));
+					state = states.back().get();
+				}
+
+				return *static_cast<thread_state*>(state);
+			}
+
+
+			/// Push a sampled call to the queue of the current thread.
+			inline void push(Arg x, R y) {
+
+				thread_state& state = local_state();
+
+				if(!state.queue.push(sample { x, y }))
+					state.dropped++;
+			}
+
+
+			/// Process all queued samples, returning whether
+			/// any sample was processed.
+			inline bool drain() {
+
+				std::vector<thread_state*> current;
+
+				{
+					std::lock_guard<std::mutex> lock (statesMutex);
+					for (auto& state : states)
+						current.push_back(state.get());
+				}
+
+				bool processed = false;
+				shadow::accumulator total;
+				uint64_t dropped = 0;
+				sample s;
+
+				for (thread_state* state : current) {
+
+					while(state->queue.pop(s)) {
+
+						const long double expected = (long double) funcExpected(s.x);
+						const long double diff = std::abs((long double) s.y - expected);
+
+						state->acc.add(s.x, diff, expected, diff / ulp<R>(expected));
+						processed = true;
+					}
+
+					total.merge(state->acc);
+					dropped += state->dropped.load(std::memory_order_relaxed);
+				}
+
+				if(processed)
+					update(total, dropped);
+
+				return processed;
+			}
+
+
+			/// Update the snapshot of the statistics.
+			inline void update(const shadow::accumulator& total, uint64_t dropped) {
+
+				estimate_result res {};
+				res.name = name;
+				res.tolerance = opt.tolerance;
+				res.iterations = total.samples;
+
+				if(total.samples) {
+					res.maxErr = total.max;
+					res.meanErr = total.sum / total.samples;
+					res.rmsErr = std::sqrt(total.sumSqr / total.samples);
+					res.absErr = total.sum;
+					res.relErr = std::abs(total.sum / total.sumAbs);
+				}
+
+				res.additionalFields["maxUlp"] = total.maxUlp;
+				res.additionalFields["meanUlp"] = total.samples ? (total.sumUlp / total.samples) : 0;
+				res.additionalFields["worstInput"] = total.worstInput;
+				res.additionalFields["samples"] = total.samples;
+				res.additionalFields["dropped"] = dropped;
+				res.failed = (res.maxErr > res.tolerance) || (res.maxErr != res.maxErr);
+
+				std::lock_guard<std::mutex> lock (snapshotMutex);
+				snapshot = res;
+			}
+
+
+			/// Write the snapshot to the export files,
+			/// overwriting their contents.
+			inline void export_files() const {
+
+				std::map<std::string, std::vector<estimate_result>> res;
+				res[name].push_back(result());
+
+				const auto table = output::generate_table(res, opt.columns);
+
+				for (const std::string& filename : opt.exportFiles) {
+
+					std::ofstream file (filename, std::ios::trunc);
+					const auto it = output::settings.fileOutputFormat.find(filename);
+
+					if(it != output::settings.fileOutputFormat.end())
+						file << it->second(table, opt.columns, output::settings);
+					else if(output::settings.defaultFileOutputFormat)
+						file << output::settings.defaultFileOutputFormat(table, opt.columns, output::settings);
+				}
+			}
+
+
+			/// Main loop of the background thread.
+			inline void run() {
+
+				benchmark::timer lastExport;
+
+				while(!stop.load()) {
+
+					const bool processed = drain();
+					passes++;
+
+					if(opt.exportInterval && lastExport() >= opt.exportInterval) {
+						export_files();
+						lastExport.start();
+					}
+
+					if(!processed)
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+
+				drain();
+				passes++;
+			}
+
+		public:
+
+			/// Construct a shadow sampler of an approximation,
+			/// starting its background thread.
+			///
+			/// @param name The name of the sampled function
+			/// @param funcApprox The approximation, which is called by operator()
+			/// (may be empty if only observe() is used)
+			/// @param funcExpected The reference function
+			/// @param opt The options of the sampler
+			shadow_sampler(
+				const std::string& name,
+				std::function<R(Arg)> funcApprox,
+				std::function<R(Arg)> funcExpected,
+				const shadow_options& opt = shadow_options())
+			: name(name), funcApprox(funcApprox), funcExpected(funcExpected), opt(opt),
+				id(shadow::allocate_id()),
+				period(std::max(opt.period, 1u)) {
+
+				output::setup();
+				update(shadow::accumulator(), 0);
+
+				// The output settings are local to each thread, so the
+				// background thread exports the results with a copy of
+				// the formatting options of the constructing thread
+				output::output_settings format;
+				output::copy_format(format, output::settings);
+
+				worker = std::thread([this, format = std::move(format)]() {
+					output::copy_format(output::settings, format);
+					run();
+				});
+			}
+
+
+			/// Stop the background thread after processing
+			/// all queued samples.
+			~shadow_sampler() {
+
+				stop = true;
+				worker.join();
+			}
+
+
+			shadow_sampler(const shadow_sampler&) = delete;
+			shadow_sampler& operator=(const shadow_sampler&) = delete;
+
+
+			/// Observe a call of the approximation with the given
+			/// input and result, sampling it once every period calls
+			/// of the current thread, and return the result.
+			inline R observe(Arg x, R y) {
+
+				// Count down the calls to the next sample, honouring
+				// the exact period (which need not be a power of two)
+				unsigned int& count = shadow::counters()[id];
+
+				if(++count >= period) {
+					count = 0;
+					push(x, y);
+				}
+
+				return y;
+			}
+
+
+			/// Call the approximation, sampling the call
+			/// once every period calls of the current thread.
+			inline R operator()(Arg x) {
+				return observe(x, funcApprox(x));
+			}
+
+
+			/// Wait until all the samples queued before
+			/// the call have been processed.
+			inline void flush() const {
+
+				const uint64_t target = passes.load() + 2;
+
+				while(passes.load() < target && !stop.load())
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+
+			/// Get the current statistics of the sampler.
+			inline estimate_result result() const {
+
+				std::lock_guard<std::mutex> lock (snapshotMutex);
+				return snapshot;
+			}
+
+
+			/// Print the current statistics to standard output
+			/// and to the export files, using the output formats.
+			inline void export_results() const {
+
+				std::map<std::string, std::vector<estimate_result>> res;
+				res[name].push_back(result());
+
+				output::print_results(res, opt.columns, opt.exportFiles);
+			}
+
+
+			/// Register the current statistics as a result
+			/// of the precision testing module.
+			inline void register_result() const {
+
+				const estimate_result res = result();
+
+				results.totalTests++;
+				if(res.failed)
+					results.failedTests++;
+
+				metrics::test_case("prec", res.name, res.failed);
+
+				results.estimateResults[name].push_back(res);
+			}
+	};
+
+}}
+
+#endif
@@ -0,0 +1,219 @@
+///
+/// @file static_estimate.h Compile time precision checks.
+///
+
+#ifndef CHEBYSHEV_STATIC_ESTIMATE_H
+#define CHEBYSHEV_STATIC_ESTIMATE_H
+
+#include "../core/common.h"
+#include "./interval.h"
+#include "./distance.h"
+
+
+namespace chebyshev {
+namespace prec {
+
+
+	/// @class static_estimate_result
+	/// A literal structure holding the result of a precision estimate
+	/// computed at compile time by prec::static_estimate.
+	/// The result may be checked with static_assert or registered
+	/// at runtime using prec::estimate.
+	struct static_estimate_result {
+
+		/// Interval of estimation.
+		interval domain {};
+
+		/// Tolerance on the max absolute error.
+		long double tolerance = 0;
+
+		/// Maximum absolute error on the nodes.
+		long double maxErr = 0;
+
+		/// Estimated mean error on interval.
+		long double meanErr = 0;
+
+		/// Estimated RMS error on interval.
+		long double rmsErr = 0;
+
+		/// Estimated relative error on interval.
+		long double relErr = 0;
+
+		/// Estimated absolute error on interval.
+		long double absErr = 0;
+
+		/// Number of quadrature subintervals.
+		unsigned int iterations = 0;
+
+		/// Whether the maximum error exceeds the tolerance.
+		bool failed = true;
+	};
+
+
+	/// @class static_equation_result
+	/// A literal structure holding the result of an equation
+	/// evaluated at compile time by prec::static_equals.
+	struct static_equation_result {
+
+		/// Evaluated value.
+		long double evaluated = 0;
+
+		/// Expected value.
+		long double expected = 0;
+
+		/// Absolute difference between the values.
+		long double difference = 0;
+
+		/// Tolerance on the absolute difference.
+		long double tolerance = 0;
+
+		/// Whether the difference exceeds the tolerance.
+		bool failed = true;
+
+		/// Whether the equation holds up to the tolerance,
+		/// so that the result may be used directly in static_assert.
+		constexpr operator bool() const {
+			return !failed;
+		}
+	};
+
+
+	/// Square root of a non-negative number which may be evaluated
+	/// at compile time, computed using Newton's method. The argument
+	/// is first scaled by powers of 4 into [1, 4), so that the
+	/// iteration converges in a few steps for any argument.
+	inline constexpr long double static_sqrt(long double x) {
+
+		if(x <= 0 || x != x)
+			return (x == 0) ? 0 : get_nan<long double>();
+
+		if(x > std::numeric_limits<long double>::max())
+			return x;
+
+		// Scale by 2^64 and then by 4, keeping track of the
+		// square root of the scale factor
+		const long double big = 18446744073709551616.0L;
+		long double scale = 1;
+
+		while(x >= big) {
+			x /= big;
+			scale *= 4294967296.0L;
+		}
+
+		while(x >= 4) {
+			x /= 4;
+			scale *= 2;
+		}
+
+		while(x < 1 / big) {
+			x *= big;
+			scale /= 4294967296.0L;
+		}
+
+		while(x < 1) {
+			x *= 4;
+			scale /= 2;
+		}
+
+		long double y = 2;
+
+		// Newton's iteration decreases monotonically
+		// from above, so it stops when it stalls.
+		while(true) {
+
+			const long double next = (y + x / y) / 2;
+
+			if(next >= y)
+				break;
+
+			y = next;
+		}
+
+		return y * scale;
+	}
+
+
+	/// Estimate error integrals over a function with respect to an
+	/// exact function at compile time, using Simpson's quadrature
+	/// over a fixed number of subintervals. Both functions must be
+	/// usable in constant expressions (e.g. pointers to constexpr
+	/// functions or, since C++17, constexpr lambdas).
+	///
+	/// @param funcApprox The approximation to test
+	/// @param funcExpected The expected result
+	/// @param domain The interval of estimation
+	/// @param tolerance The tolerance on the maximum absolute error
+	/// @return A literal structure holding the estimate
+	template<unsigned int Iterations = 100, typename Function1, typename Function2>
+	inline constexpr static_estimate_result static_estimate(
+		Function1 funcApprox,
+		Function2 funcExpected,
+		interval domain,
+		long double tolerance = CHEBYSHEV_PREC_TOLERANCE) {
+
+		static_assert(Iterations && Iterations % 2 == 0,
+			"The number of iterations of prec::static_estimate must be even and positive");
+
+		const long double length = domain.length();
+		const long double dx = length / Iterations;
+
+		long double sum = 0;
+		long double sumSqr = 0;
+		long double sumAbs = 0;
+		long double max = 0;
+
+		for (unsigned int i = 0; i <= Iterations; ++i) {
+
+			const long double x = (i == Iterations) ? domain.b : (domain.a + i * dx);
+			const long double expected = funcExpected(x);
+			const long double diff = distance::abs_distance<long double>(funcApprox(x), expected);
+			const long double coeff = (i == 0 || i == Iterations) ? 1 : ((i % 2) ? 4 : 2);
+
+			if(diff > max || diff != diff)
+				max = (max != max) ? max : diff;
+
+			sum += coeff * diff;
+			sumSqr += coeff * diff * diff;
+			sumAbs += coeff * (expected > 0 ? expected : -expected);
+		}
+
+		static_estimate_result res {};
+		res.domain = domain;
+		res.tolerance = tolerance;
+		res.iterations = Iterations;
+		res.maxErr = max;
+		res.absErr = sum * dx / 3.0;
+		res.meanErr = res.absErr / length;
+		res.rmsErr = static_sqrt((sumSqr * dx / 3.0) / length);
+		res.relErr = (sumAbs != 0) ? (sum / sumAbs) : get_nan<long double>();
+		res.failed = (max > tolerance) || (max != max);
+
+		return res;
+	}
+
+
+	/// Test an equivalence up to a tolerance at compile time.
+	/// The result is implicitly convertible to bool, so that it may
+	/// be checked using static_assert or registered at runtime
+	/// using prec::equals.
+	///
+	/// @param evaluated The evaluated value
+	/// @param expected The expected value
+	/// @param tolerance The tolerance on the absolute difference
+	inline constexpr static_equation_result static_equals(
+		long double evaluated, long double expected,
+		long double tolerance = CHEBYSHEV_PREC_TOLERANCE) {
+
+		static_equation_result res {};
+		res.evaluated = evaluated;
+		res.expected = expected;
+		res.difference = distance::abs_distance<long double>(evaluated, expected);
+		res.tolerance = tolerance;
+		res.failed = (res.difference > tolerance) || (res.difference != res.difference);
+
+		return res;
+	}
+
+}}
+
+#endif
@@ -0,0 +1,566 @@
+///
+/// @file sweep.h Sweep estimation over a shared set of nodes.
+///
+
+#ifndef CHEBYSHEV_SWEEP_H
+#define CHEBYSHEV_SWEEP_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cfenv>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../core/common.h"
+#include "./prec_structures.h"
+#include "./fail.h"
+#include "./multi_double.h"
+
+
+namespace chebyshev {
+namespace prec {
+
+
+	/// @class float_traits
+	/// Properties of a floating point type which are needed
+	/// to measure errors in units in the last place (ULP).
+	/// The class may be specialized for custom floating point types.
+	template<typename FloatType>
+	struct float_traits {
+
+		/// Machine epsilon of the type.
+		static long double epsilon() {
+			return std::numeric_limits<FloatType>::epsilon();
+		}
+
+		/// Number of bits of the significand, used to
+		/// compare the precision of types at compile time.
+		static constexpr int digits() {
+			return std::numeric_limits<FloatType>::digits;
+		}
+
+		/// Minimum exponent of a normal number, following
+		/// the convention of std::numeric_limits.
+		static int min_exponent() {
+			return std::numeric_limits<FloatType>::min_exponent;
+		}
+
+		/// Name of the type, used to name sweep results.
+		static std::string name() {
+			return "unknown";
+		}
+	};
+
+
+	template<>
+	inline std::string float_traits<float>::name() {
+		return "float";
+	}
+
+
+	template<>
+	inline std::string float_traits<double>::name() {
+		return "double";
+	}
+
+
+	template<>
+	inline std::string float_traits<long double>::name() {
+		return "long double";
+	}
+
+
+#ifdef __SIZEOF_FLOAT128__
+
+	/// Properties of the __float128 extension type,
+	/// for which std::numeric_limits is not specialized
+	/// in strict standard mode. Sweep estimation evaluates
+	/// this type on nodes which are representable in long double
+	/// and compares its values with a quad_double reference.
+	template<>
+	struct float_traits<__float128> {
+
+		static long double epsilon() {
+			return std::ldexp(1.0L, -112);
+		}
+
+		static constexpr int digits() {
+			return 113;
+		}
+
+		static int min_exponent() {
+			return -16381;
+		}
+
+		static std::string name() {
+			return "__float128";
+		}
+	};
+
+#endif
+
+
+	/// Properties of double-double numbers, following
+	/// the conventions of the QD library.
+	template<>
+	struct float_traits<double_double> {
+
+		static long double epsilon() {
+			return std::ldexp(1.0L, -104);
+		}
+
+		static constexpr int digits() {
+			return 106;
+		}
+
+		static int min_exponent() {
+			return std::numeric_limits<double>::min_exponent + 53;
+		}
+
+		static std::string name() {
+			return "double_double";
+		}
+	};
+
+
+	/// Properties of quad-double numbers, following
+	/// the conventions of the QD library.
+	template<>
+	struct float_traits<quad_double> {
+
+		static long double epsilon() {
+			return std::ldexp(1.0L, -209);
+		}
+
+		static constexpr int digits() {
+			return 212;
+		}
+
+		static int min_exponent() {
+			return std::numeric_limits<double>::min_exponent + 159;
+		}
+
+		static std::string name() {
+			return "quad_double";
+		}
+	};
+
+
+	/// Compute the spacing between consecutive numbers of type
+	/// FloatType around a given value, that is, the size of
+	/// one unit in the last place.
+	///
+	/// @param y The value to compute the spacing at
+	/// @return The size of one ULP of FloatType at y
+	template<typename FloatType>
+	inline long double ulp(long double y) {
+
+		const int minExp = float_traits<FloatType>::min_exponent() - 1;
+		int exponent = std::ilogb(y);
+
+		// Subnormal numbers and zero share the spacing
+		// of the smallest normal number.
+		if(y == 0 || exponent < minExp)
+			exponent = minExp;
+
+		// The spacing of subnormal __float128 numbers
+		// underflows in long double
+		return std::max(std::ldexp(float_traits<FloatType>::epsilon(), exponent),
+			std::numeric_limits<long double>::denorm_min());
+	}
+
+
+	/// @namespace chebyshev::prec::sweep Shared node sets for sweep estimation
+	///
+	/// Sweep estimation evaluates an approximation multiple times
+	/// over the same nodes (e.g. in different floating point types
+	/// or rounding modes), evaluating the reference function only once
+	/// per node. Nodes are placed on Simpson's quadrature grid, so that
+	/// the error integrals are consistent with estimator::quadrature1D.
+	namespace sweep {
+
+
+		/// The rounding modes supported by the platform
+		/// among the four modes of IEEE 754, starting
+		/// with rounding to nearest.
+		inline std::vector<int> rounding_modes() {
+
+			std::vector<int> modes;
+
+#ifdef FE_TONEAREST
+			modes.push_back(FE_TONEAREST);
+#endif
+#ifdef FE_UPWARD
+			modes.push_back(FE_UPWARD);
+#endif
+#ifdef FE_DOWNWARD
+			modes.push_back(FE_DOWNWARD);
+#endif
+#ifdef FE_TOWARDZERO
+			modes.push_back(FE_TOWARDZERO);
+#endif
+
+			return modes;
+		}
+
+
+		/// Name of a rounding mode, used to name sweep results.
+		inline std::string rounding_name(int mode) {
+
+			switch(mode) {
+#ifdef FE_TONEAREST
+				case FE_TONEAREST: return "nearest";
+#endif
+#ifdef FE_UPWARD
+				case FE_UPWARD: return "upward";
+#endif
+#ifdef FE_DOWNWARD
+				case FE_DOWNWARD: return "downward";
+#endif
+#ifdef FE_TOWARDZERO
+				case FE_TOWARDZERO: return "toward zero";
+#endif
+				default: return "mode " + std::to_string(mode);
+			}
+		}
+
+
+		/// @class reference_type
+		/// Marker of the reference type of a sweep, which may be passed
+		/// as the first of the swept types (e.g. estimate_sweep<
+		/// sweep::reference_type<quad_double>, float, double>).
+		template<typename Type>
+		struct reference_type {
+			using type = Type;
+		};
+
+
+		/// @class types
+		/// A list of swept types.
+		template<typename ...Types>
+		struct types {};
+
+
+		/// Maximum number of significand bits among the given types.
+		template<typename ...Types>
+		constexpr int max_digits() {
+
+			const int digits[] = { 0, float_traits<Types>::digits()... };
+			int res = 0;
+
+			for (int d : digits)
+				res = (d > res) ? d : res;
+
+			return res;
+		}
+
+
+		/// The least precise among long double, double_double and
+		/// quad_double which is more precise than all the given types,
+		/// used as the reference type of a sweep by default.
+		template<typename ...Types>
+		using default_reference = typename std::conditional<
+			(max_digits<Types...>() < float_traits<long double>::digits()),
+			long double,
+			typename std::conditional<
+				(max_digits<Types...>() < float_traits<double_double>::digits()),
+				double_double, quad_double>::type>::type;
+
+
+		/// @class split
+		/// The reference type and the swept types of a sweep,
+		/// given the template arguments of prec::estimate_sweep.
+		template<typename ...Types>
+		struct split {
+			using reference = reference_type<default_reference<Types...>>;
+			using swept = types<Types...>;
+		};
+
+
+		/// The reference type and the swept types of a sweep
+		/// with an explicit reference type.
+		template<typename ReferenceType, typename ...Types>
+		struct split<reference_type<ReferenceType>, Types...> {
+			using reference = reference_type<ReferenceType>;
+			using swept = types<Types...>;
+		};
+
+
+		/// @class convert
+		/// Exact conversion of a floating point value to the reference
+		/// type, summing its leading doubles. The conversion is exact
+		/// when the reference type is at least as precise as the value.
+		template<typename ReferenceType>
+		struct convert {
+
+			template<typename FloatType>
+			static ReferenceType from(FloatType v) {
+
+				ReferenceType res = 0;
+
+				for (unsigned int i = 0; i < 4; ++i) {
+
+					const double c = (double) v;
+					res = res + ReferenceType(c);
+
+					// Stop on zero, infinities and NaN
+					if(c == 0 || c - c != 0)
+						break;
+
+					v = v - (FloatType) c;
+				}
+
+				return res;
+			}
+		};
+
+
+		/// Conversion of a floating point value to long double.
+		template<>
+		struct convert<long double> {
+
+			template<typename FloatType>
+			static long double from(FloatType v) {
+				return (long double) v;
+			}
+		};
+
+
+		/// Generate Simpson's quadrature nodes over an interval,
+		/// rounded so that they are exactly representable
+		/// in all the given types.
+		///
+		/// @param domain The interval to generate nodes on
+		/// @param iterations The number of subintervals
+		/// (rounded up to the next even number)
+		/// @return The vector of nodes, of size iterations + 1
+		template<typename ...Types>
+		inline std::vector<long double> nodes(interval domain, unsigned int iterations) {
+
+			if(iterations % 2)
+				iterations++;
+
+			const long double dx = domain.length() / iterations;
+			std::vector<long double> x (iterations + 1);
+
+			for (unsigned int i = 0; i <= iterations; ++i) {
+
+				long double node = (i == iterations) ? domain.b : (domain.a + i * dx);
+
+				// Round the node through every type, so that
+				// all types are evaluated on the same input.
+				long double rounded[] = { node, (node = (long double) (Types) node)... };
+				x[i] = node;
+				(void) rounded;
+			}
+
+			return x;
+		}
+
+
+		/// Simpson's quadrature weight of the i-th node
+		/// out of a grid of n + 1 nodes.
+		inline long double weight(size_t i, size_t n) {
+
+			if(i == 0 || i == n)
+				return 1;
+
+			return (i % 2) ? 4 : 2;
+		}
+
+
+		/// @class accumulator
+		/// Running sums of the error over a quadrature grid.
+		struct accumulator {
+
+			/// Weighted sum of absolute errors.
+			long double sum = 0;
+
+			/// Weighted sum of squared errors.
+			long double sumSqr = 0;
+
+			/// Weighted sum of absolute expected values.
+			long double sumAbs = 0;
+
+			/// Maximum error (NaN if any error was NaN).
+			long double max = 0;
+
+
+			/// Add the error at a node with the given weight.
+			inline void add(long double diff, long double expected, long double weight) {
+
+				if(diff > max || diff != diff)
+					max = (max != max) ? max : diff;
+
+				sum += weight * diff;
+				sumSqr += weight * diff * diff;
+				sumAbs += weight * std::abs(expected);
+			}
+
+
+			/// Convert the running sums to an estimate result,
+			/// given the grid step and the length of the domain.
+			inline estimate_result result(long double dx, long double length) const {
+
+				estimate_result res {};
+				res.maxErr = max;
+				res.absErr = sum * dx / 3.0;
+				res.meanErr = res.absErr / length;
+				res.rmsErr = std::sqrt((sumSqr * dx / 3.0) / length);
+				res.relErr = std::abs(sum / sumAbs);
+
+				return res;
+			}
+		};
+
+
+		/// Evaluate a generic approximation in FloatType at all the
+		/// nodes under the given rounding mode. The rounding mode is
+		/// switched once for the whole batch of nodes and the previous
+		/// mode is restored before returning.
+		///
+		/// @param funcApprox The approximation, callable with a FloatType
+		/// @param x The shared nodes
+		/// @param mode The rounding mode (e.g. FE_UPWARD)
+		/// @return The values of the approximation at the nodes,
+		/// converted exactly to the reference type
+		template<typename FloatType, typename ReferenceType, typename Function>
+		inline std::vector<ReferenceType> evaluate(
+			Function funcApprox,
+			const std::vector<long double>& x,
+			int mode) {
+
+			std::vector<ReferenceType> y (x.size());
+			const int previous = std::fegetround();
+
+			if(mode != previous && std::fesetround(mode))
+				throw std::runtime_error(
+					"Unsupported rounding mode in chebyshev::prec::sweep::evaluate");
+
+			try {
+
+				for (size_t i = 0; i < x.size(); ++i)
+					y[i] = convert<ReferenceType>::from(funcApprox((FloatType) x[i]));
+
+			} catch(...) {
+				std::fesetround(previous);
+				throw;
+			}
+
+			std::fesetround(previous);
+			return y;
+		}
+
+
+		/// Estimate the error of the values of an approximation
+		/// in FloatType with respect to precomputed reference values,
+		/// also measuring the error in ULPs of FloatType. The differences
+		/// are computed in the reference type, which must be more precise
+		/// than FloatType. The maximum and mean ULP errors are stored
+		/// in the "maxUlp" and "meanUlp" additional fields.
+		///
+		/// @param approx The values of the approximation at the nodes
+		/// @param expected The reference values at the nodes
+		/// @param domain The domain of estimation
+		template<typename FloatType, typename ReferenceType>
+		inline estimate_result measure(
+			const std::vector<ReferenceType>& approx,
+			const std::vector<ReferenceType>& expected,
+			interval domain) {
+
+			static_assert(float_traits<FloatType>::digits() < float_traits<ReferenceType>::digits(),
+				"The reference type of a sweep must be more precise than the swept types");
+
+			const size_t n = approx.size() - 1;
+			const long double length = domain.length();
+			const long double dx = length / n;
+
+			accumulator acc;
+			long double maxUlp = 0;
+			long double sumUlp = 0;
+
+			for (size_t i = 0; i <= n; ++i) {
+
+				const long double diff = std::abs(static_cast<long double>(approx[i] - expected[i]));
+				const long double exact = static_cast<long double>(expected[i]);
+				const long double w = weight(i, n);
+
+				acc.add(diff, exact, w);
+
+				const long double ulps = diff / ulp<FloatType>(exact);
+
+				if(ulps > maxUlp || ulps != ulps)
+					maxUlp = (maxUlp != maxUlp) ? maxUlp : ulps;
+
+				sumUlp += w * ulps;
+			}
+
+			estimate_result res = acc.result(dx, length);
+			res.additionalFields["maxUlp"] = maxUlp;
+			res.additionalFields["meanUlp"] = (sumUlp * dx / 3.0) / length;
+
+			return res;
+		}
+
+
+		/// Estimate the error of a generic approximation evaluated
+		/// in FloatType over precomputed nodes and reference values,
+		/// in the current rounding mode.
+		///
+		/// @param funcApprox The approximation, callable with a FloatType
+		/// @param x The shared nodes
+		/// @param expected The reference values at the nodes
+		/// @param domain The domain of estimation
+		template<typename FloatType, typename ReferenceType, typename Function>
+		inline estimate_result estimate(
+			Function funcApprox,
+			const std::vector<long double>& x,
+			const std::vector<ReferenceType>& expected,
+			interval domain) {
+
+			return measure<FloatType>(
+				evaluate<FloatType, ReferenceType>(funcApprox, x, std::fegetround()),
+				expected, domain);
+		}
+
+
+		/// Estimate the error of a generic approximation evaluated
+		/// in FloatType under each of the given rounding modes,
+		/// over the same nodes and reference values. If no rounding
+		/// mode is given, the current mode is used.
+		///
+		/// @param funcApprox The approximation, callable with a FloatType
+		/// @param x The shared nodes
+		/// @param expected The reference values at the nodes
+		/// @param domain The domain of estimation
+		/// @param modes The rounding modes
+		/// @return A result for each rounding mode
+		template<typename FloatType, typename ReferenceType, typename Function>
+		inline std::vector<estimate_result> estimate(
+			Function funcApprox,
+			const std::vector<long double>& x,
+			const std::vector<ReferenceType>& expected,
+			interval domain,
+			const std::vector<int>& modes) {
+
+			if(!modes.size())
+				return { estimate<FloatType>(funcApprox, x, expected, domain) };
+
+			std::vector<estimate_result> res;
+			res.reserve(modes.size());
+
+			for (int mode : modes)
+				res.push_back(measure<FloatType>(
+					evaluate<FloatType, ReferenceType>(funcApprox, x, mode), expected, domain));
+
+			return res;
+		}
+
+	}
+
+}}
+
+#endif
@@ -0,0 +1,298 @@
+///
+/// @file tail.h Extreme value estimation of the maximum error.
+///
+
+#ifndef CHEBYSHEV_TAIL_H
+#define CHEBYSHEV_TAIL_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include "../core/common.h"
+#include "../core/random.h"
+#include "./prec_structures.h"
+
+
+namespace chebyshev {
+
+	namespace prec {
+
+
+		/// @namespace chebyshev::prec::tail Extreme value estimation
+		///
+		/// The maximum of a sample of errors underestimates the maximum
+		/// error over the domain unless the number of samples is very
+		/// large. The largest errors observed by an estimator are kept in
+		/// a bounded heap and their exceedances over the smallest of them
+		/// are fitted with a generalized Pareto distribution, by probability
+		/// weighted moments (Hosking and Wallis). For bounded tails (negative
+		/// shape, the common case for rounding and approximation errors)
+		/// the maximum error is extrapolated to the upper endpoint of the
+		/// distribution, otherwise to the expected maximum of a larger
+		/// sample. An upper confidence bound is computed by bootstrap
+		/// resampling of the exceedances.
+		namespace tail {
+
+
+			/// @class tail_heap
+			/// A bounded min-heap keeping the largest values
+			/// of a sequence and the number of observed values.
+			class tail_heap {
+
+				std::vector<long double> values;
+				size_t capacity;
+				size_t observed;
+
+				public:
+
+				/// Construct a heap keeping the given number of largest values.
+				tail_heap(size_t capacity) : capacity(capacity), observed(0) {
+					values.reserve(capacity);
+				}
+
+
+				/// Observe a value, keeping it if it is among the largest.
+				/// NaN values are not kept.
+				inline void push(long double x) {
+
+					observed++;
+
+					if(!capacity || x != x)
+						return;
+
+					if(values.size() < capacity) {
+						values.push_back(x);
+						std::push_heap(values.begin(), values.end(), std::greater<long double>());
+						return;
+					}
+
+					if(x <= values.front())
+						return;
+
+					std::pop_heap(values.begin(), values.end(), std::greater<long double>());
+					values.back() = x;
+					std::push_heap(values.begin(), values.end(), std::greater<long double>());
+				}
+
+
+				/// Returns the kept values in ascending order.
+				inline std::vector<long double> sorted() const {
+
+					std::vector<long double> res = values;
+					std::sort(res.begin(), res.end());
+					return res;
+				}
+
+
+				/// Returns the total number of observed values.
+				inline size_t count() const {
+					return observed;
+				}
+			};
+
+
+			/// @class gpd_fit
+			/// A generalized Pareto distribution fitted
+			/// to the exceedances over a threshold.
+			struct gpd_fit {
+
+				/// The threshold of the exceedances.
+				long double threshold = 0;
+
+				/// Shape parameter (negative for bounded tails).
+				long double shape = 0;
+
+				/// Scale parameter.
+				long double scale = 0;
+
+				/// Probability of exceeding the threshold.
+				long double rate = 0;
+
+				/// Whether the fit succeeded.
+				bool valid = false;
+			};
+
+
+			/// Fit a generalized Pareto distribution to exceedances
+			/// by probability weighted moments.
+			///
+			/// @param excess The exceedances over the threshold, in ascending order
+			/// @param threshold The threshold
+			/// @param rate The probability of exceeding the threshold
+			inline gpd_fit fit(const std::vector<long double>& excess, long double threshold, long double rate) {
+
+				gpd_fit res;
+				res.threshold = threshold;
+				res.rate = rate;
+
+				const size_t m = excess.size();
+
+				if(m < 2)
+					return res;
+
+				long double a0 = 0;
+				long double a1 = 0;
+
+				for (size_t i = 0; i < m; ++i) {
+					a0 += excess[i];
+					a1 += excess[i] * (m - 1 - i) / (long double) (m - 1);
+				}
+
+				a0 /= m;
+				a1 /= m;
+
+				const long double d = a0 - 2 * a1;
+
+				if(!(d > 0) || !(a0 > 0))
+					return res;
+
+				res.shape = 2 - a0 / d;
+				res.scale = 2 * a0 * a1 / d;
+				res.valid = res.scale > 0;
+
+				return res;
+			}
+
+
+			/// Returns the probability of exceeding a value under
+			/// the fitted distribution, for values above the threshold.
+			inline long double exceedance(const gpd_fit& f, long double x) {
+
+				if(x <= f.threshold)
+					return f.rate;
+
+				const long double z = (x - f.threshold) / f.scale;
+
+				if(std::abs(f.shape) < 1E-12)
+					return f.rate * std::exp(-z);
+
+				const long double base = 1 + f.shape * z;
+
+				if(base <= 0)
+					return 0;
+
+				return f.rate * std::pow(base, -1 / f.shape);
+			}
+
+
+			/// Returns the extrapolated maximum of the fitted distribution:
+			/// the upper endpoint for bounded tails, otherwise the quantile
+			/// whose exceedance probability is 1 / (n * extrapolation).
+			///
+			/// @param f The fitted distribution
+			/// @param n The number of observed values
+			/// @param extrapolation The extrapolation factor for unbounded tails
+			inline long double extrapolate(const gpd_fit& f, size_t n, long double extrapolation) {
+
+				if(f.shape < -1E-12)
+					return f.threshold - f.scale / f.shape;
+
+				const long double p = 1 / (n * std::max<long double>(extrapolation, 1));
+
+				if(std::abs(f.shape) < 1E-12)
+					return f.threshold + f.scale * std::log(f.rate / p);
+
+				return f.threshold + f.scale / f.shape * (std::pow(f.rate / p, f.shape) - 1);
+			}
+
+
+			/// Estimate the maximum error from the largest observed
+			/// errors, storing the extrapolated maximum, its upper
+			/// confidence bound, the shape of the tail and the number
+			/// of samples needed to observe an error of the given level
+			/// of the extrapolated maximum in the "tailMax", "tailBound",
+			/// "tailShape" and "tailSamples" additional fields of the result.
+			/// The fields are not set if the tail may not be fitted.
+			///
+			/// @param heap The heap of the largest errors
+			/// @param opt The options of the estimate
+			/// @param res The result of the estimate
+			inline void estimate(const tail_heap& heap, const tail_options& opt, estimate_result& res) {
+
+				const std::vector<long double> largest = heap.sorted();
+				const size_t n = heap.count();
+
+				if(largest.size() < 3 || !n)
+					return;
+
+				// Exceedances over the smallest of the largest errors
+				const long double threshold = largest[0];
+				std::vector<long double> excess (largest.size() - 1);
+
+				for (size_t i = 1; i < largest.size(); ++i)
+					excess[i - 1] = largest[i] - threshold;
+
+				const long double rate = excess.size() / (long double) n;
+				const gpd_fit f = fit(excess, threshold, rate);
+				const long double observedMax = largest.back();
+
+				// All the largest errors are equal
+				if(!f.valid) {
+
+					if(excess.back() == 0) {
+						res.additionalFields["tailMax"] = observedMax;
+						res.additionalFields["tailBound"] = observedMax;
+						res.additionalFields["tailShape"] = 0;
+						res.additionalFields["tailSamples"] = n;
+					}
+
+					return;
+				}
+
+				const long double tailMax = std::max(
+					extrapolate(f, n, opt.extrapolation), observedMax);
+
+				// Bootstrap the upper confidence bound
+				std::vector<long double> bounds;
+				std::vector<long double> resample (excess.size());
+
+				for (unsigned int r = 0; r < opt.resamples; ++r) {
+
+					for (size_t i = 0; i < excess.size(); ++i)
+						resample[i] = excess[random::bounded(excess.size())];
+
+					std::sort(resample.begin(), resample.end());
+
+					const gpd_fit g = fit(resample, threshold, rate);
+					bounds.push_back(g.valid ?
+						std::max(extrapolate(g, n, opt.extrapolation), observedMax) : observedMax);
+				}
+
+				long double tailBound = tailMax;
+
+				if(bounds.size()) {
+
+					std::sort(bounds.begin(), bounds.end());
+					const size_t index = std::min<size_t>(
+						std::ceil(opt.confidence * bounds.size()), bounds.size()) - 1;
+
+					tailBound = std::max(bounds[index], tailMax);
+				}
+
+				// Samples needed to observe an error above the level
+				// with the given confidence
+				const long double p = std::min(
+					exceedance(f, opt.level * tailMax), (long double) largest.size() / n);
+
+				long double samples = std::numeric_limits<long double>::infinity();
+
+				if(observedMax >= opt.level * tailMax)
+					samples = n;
+				else if(p > 0)
+					samples = std::ceil(std::log(1 - opt.confidence) / std::log1p(-p));
+
+				res.additionalFields["tailMax"] = tailMax;
+				res.additionalFields["tailBound"] = tailBound;
+				res.additionalFields["tailShape"] = f.shape;
+				res.additionalFields["tailSamples"] = samples;
+			}
+
+		}
+
+	}
+}
+
+#endif